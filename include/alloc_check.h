@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdio.h>
+
+/* Heap check for the main loop (--alloc-check). malloc / calloc / realloc / free are
+   replaced for the whole process and forward to the C library's own. An allocation the
+   program makes on the main thread during a checked frame is counted and the first few
+   are printed with a backtrace; ones made inside libraries (the GL driver allocates in
+   draw calls) are only tallied, and so are frees. Frames count from alloc_check_frame,
+   after a warm-up for first-use caches; swap and event polling are left out with
+   alloc_check_pause. Needs glibc; elsewhere alloc_check_available is 0 and nothing is
+   replaced. */
+
+int alloc_check_available(void);
+// Start checking once warmup_frames loop iterations have gone by (Frames)
+void alloc_check_enable(int warmup_frames);
+int alloc_check_enabled(void);
+// A main loop iteration begins; call first thing in the loop body
+void alloc_check_frame(void);
+// Leave out calls into code we don't own (1 = pause, 0 = resume)
+void alloc_check_pause(int paused);
+// A main loop has exited; stop checking until the next alloc_check_frame
+void alloc_check_end(void);
+// Frames checked and heap calls caught; returns the calls caught (Output stream)
+unsigned long long alloc_check_report(FILE* out);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Single-file asset pack, mapped read-only with mmap.
+   Layout: AssetPackHeader, then payloads (each starting on an ASSET_PACK_ALIGN boundary,
+   already in the format GL wants), then the AssetEntry index at header.index_offset.
+   Loading is a lookup plus a pointer into the mapping: no read() copies, no decoding. */
+
+#define ASSET_PACK_MAGIC   0x4B415050u   // "PPAK" little-endian
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGN   4096
+#define ASSET_NAME_MAX     48
+
+typedef enum {
+    ASSET_RAW = 0,      // Bytes as-is (fonts, sounds, ...)
+    ASSET_RGBA8 = 1,    // width * height * 4, row 0 = top
+    ASSET_LA8 = 2,      // width * height * 2 (luminance, alpha)
+    ASSET_L8 = 3,       // width * height, one channel, e.g. the font distance field
+} AssetType;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+    uint64_t index_offset;
+    uint64_t file_size;
+} AssetPackHeader;
+
+typedef struct {
+    char name[ASSET_NAME_MAX];
+    uint32_t type;
+    uint32_t width, height;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+} AssetEntry;
+
+typedef struct {
+    const unsigned char* base;
+    uint64_t size;
+    const AssetPackHeader* header;
+    const AssetEntry* entries;
+} AssetPack;
+
+// Map a pack; returns 0 if it is missing or malformed (Pack, File path)
+int asset_pack_open(AssetPack* pack, const char* path);
+void asset_pack_close(AssetPack* pack);
+// Find an entry by name, optionally requiring a type (-1 = any); NULL if absent
+const AssetEntry* asset_pack_find(const AssetPack* pack, const char* name, int type);
+// Payload of an entry, pointing straight into the mapping
+const void* asset_pack_data(const AssetPack* pack, const AssetEntry* entry);
@@ -0,0 +1,16 @@
+#pragma once
+
+/* Frame capture (--capture file.y4m / file.rgba).
+   Each frame is read back from the offscreen target into a ring of pixel buffer objects
+   and only mapped once its fence has passed, a couple of frames later, so glReadPixels
+   never stalls the render loop. The pixels are copied into a small pool and a writer
+   thread converts and writes them. If the GPU or the disk falls behind, frames are
+   dropped and counted rather than waited for. */
+
+// Start writing frames; .y4m gets 4:2:0 YUV, anything else raw top-down RGBA (File path, Frames per second)
+int capture_start(const char* path, double fps);
+int capture_active(void);
+// Queue a readback of the finished scene (call before the present, with the target still bound)
+void capture_frame(void);
+// Drain the readbacks in flight, finish the file and report written / dropped frames
+void capture_stop(void);
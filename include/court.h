@@ -0,0 +1,49 @@
+#pragma once
+
+/* Static obstacles on the court, loaded from a layout file and compiled into a uniform
+   grid so a ball only tests the obstacles in the cells its path crosses.
+   Layout file: one obstacle per line in -1..1 court coordinates, '#' starts a comment.
+       rect   x y w h      bottom-left corner and size
+       circle x y r        centre and radius
+   Ball sweeps treat rectangles as grown by the ball radius on every side (square
+   corners) and circles as grown by it exactly. */
+
+#define COURT_GRID 16        // Cells per side over -1..1
+
+typedef struct {
+    float x0, y0, x1, y1;
+} CourtRect;
+
+typedef struct {
+    float x, y, r;
+} CourtCircle;
+
+typedef struct Court {
+    CourtRect* rects;
+    int rect_count;
+    CourtCircle* circles;
+    int circle_count;
+    int capacity_rects, capacity_circles;
+
+    // Obstacles per cell; rect i is entry i, circle i is entry rect_count + i
+    int cell_start[COURT_GRID * COURT_GRID + 1];
+    int* cell_items;
+} Court;
+
+typedef struct {
+    float t;                 // Fraction of the move before contact, 0..1
+    float nx, ny;            // Surface normal at the contact
+} CourtHit;
+
+void court_init(Court* court);
+void court_free(Court* court);
+// Add obstacles, then court_build before any sweep (Court, Bottom-left X, Y, Width, Height / Centre X, Y, Radius)
+void court_add_rect(Court* court, float x, float y, float w, float h);
+void court_add_circle(Court* court, float x, float y, float r);
+// Compile the grid; returns 0 on allocation failure (Court)
+int court_build(Court* court);
+// Parse a layout file and build it; returns 0 with a message on stderr if it can't (Court, File path)
+int court_load(Court* court, const char* path);
+
+// Earliest contact of a ball moving by (dx, dy) this tick; returns 0 if nothing is hit (Court, X, Y, DX, DY, Radius, Output)
+int court_sweep(const Court* court, float x, float y, float dx, float dy, float radius, CourtHit* hit);
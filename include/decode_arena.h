@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Scoped arena for asset decoding. Between decode_arena_begin and decode_arena_end,
+   stb_image's STBI_MALLOC / STBI_REALLOC_SIZED / STBI_FREE hooks (see text.c) carve
+   blocks out of one block reserved up front; the newest block grows and shrinks in
+   place, everything else is released at once by decode_arena_end and the space is
+   reused by the next scope. A request past the cap fails, so stb_image reports out of
+   memory instead of the process growing. Outside a scope the hooks are plain malloc.
+   One scope at a time per thread; a scope only catches its own thread's allocations. */
+
+typedef struct {
+    unsigned char* base;
+    size_t size;             // Cap, reserved at init
+    size_t used;
+    size_t newest;           // Offset of the newest block, or size if it was freed
+    size_t scope_peak;       // Most used during the current / last scope
+    size_t high_water;       // Most used in any scope
+    unsigned allocations;    // Blocks handed out, over every scope
+    unsigned failed;         // Requests past the cap
+} DecodeArena;
+
+// Reserve the block; pages only become resident once a decode touches them (Arena, Cap in bytes)
+int decode_arena_init(DecodeArena* arena, size_t bytes);
+void decode_arena_release(DecodeArena* arena);
+// Route the hooks to this arena until decode_arena_end, which frees the whole scope (Arena)
+void decode_arena_begin(DecodeArena* arena);
+void decode_arena_end(DecodeArena* arena);
+
+// The hooks themselves (Bytes / Block, Old size, New size / Block)
+void* decode_malloc(size_t bytes);
+void* decode_realloc(void* block, size_t old_bytes, size_t bytes);
+void decode_free(void* block);
+
+// Peak of the last scope, overall high-water mark, cap and failures (Arena, Label, Output stream)
+void decode_arena_report(const DecodeArena* arena, const char* label, FILE* out);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+
+/* Dynamic resolution: shrinks or grows the drawn part of the offscreen target to hold a
+   frame time budget. Frame cost comes from GPU timer queries (read a few frames late, so
+   nothing stalls) or, without them, from CPU time between the pacer waking and the scene
+   being finished (glFinish'd, so a vsync wait in the swap never counts as work).
+   Shrinking needs a few frames over budget, growing needs a second well under it, and
+   each change is followed by a cooldown; the gap between the two keeps it from
+   oscillating. */
+
+#define DYNAMIC_RES_QUERIES 4
+
+typedef struct {
+    int enabled;
+    uint64_t budget_ns;      // Frame cost to hold
+    float min_scale;
+    float scale;
+    double cost_ns;          // Smoothed measured cost
+    int over, under;         // Consecutive samples above budget / well below it
+    int cooldown;            // Samples to ignore after a change
+    unsigned changes;
+    uint64_t begin_ns;
+    int gpu;                 // 1 = timer queries, 0 = CPU timing
+    GLuint queries[DYNAMIC_RES_QUERIES];
+    int pending[DYNAMIC_RES_QUERIES];
+    int head;                // Next query slot to use
+    int timing;              // A query is open for the current frame
+} DynamicRes;
+
+// Start controlling render_target's scale (Controller, Budget ms, Minimum scale)
+void dynamic_res_init(DynamicRes* dr, double budget_ms, float min_scale);
+void dynamic_res_shutdown(DynamicRes* dr);
+// Frame work starts (call right after the pacer wakes)
+void dynamic_res_frame_begin(DynamicRes* dr);
+// Scene finished, before it is presented; measures and adjusts the scale for the next frame
+void dynamic_res_frame_end(DynamicRes* dr);
+// Print the number of changes and the final scale (Controller)
+void dynamic_res_summary(const DynamicRes* dr);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Bump allocator for data that only lives until the end of the frame: a pointer moves
+   up one fixed block and frame_arena_reset, at the top of every main loop iteration,
+   takes it back to the start. Nothing is freed on its own and nothing touches the heap
+   after init; a request that doesn't fit returns NULL and is counted, so size the
+   arena from the high-water mark the report prints. */
+
+// Reserve the block once (Bytes)
+int frame_arena_init(size_t bytes);
+void frame_arena_shutdown(void);
+// Forget everything allocated this frame
+void frame_arena_reset(void);
+// 16-byte aligned memory valid until the next reset; NULL if the arena is full (Bytes)
+void* frame_alloc(size_t bytes);
+// printf into the arena; "" if it doesn't fit (Format, ...)
+char* frame_printf(const char* format, ...);
+// Size, high-water mark and failed requests (Output stream)
+void frame_arena_report(FILE* out);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Frame scheduler with absolute deadlines.
+   Sleeps with clock_nanosleep(TIMER_ABSTIME) until shortly before the wake time and
+   spins the rest. The wake time is the frame deadline minus the predicted frame work,
+   so input polled right after frame_pacer_wait() is as fresh as possible (late latch). */
+
+typedef struct {
+    uint64_t period_ns;      // 0 = uncapped
+    uint64_t deadline_ns;    // When the frame currently being built should be swapped
+    uint64_t spin_ns;        // Spin instead of sleep for the final stretch
+    uint64_t work_ns;        // Predicted wake-to-swap time (decaying max)
+    uint64_t woke_ns;        // When the last wait returned
+    uint64_t frames;
+    uint64_t missed;
+    uint64_t worst_miss_ns;  // Largest overshoot past a deadline
+    int late_latch;
+    const char* name;        // Label for the summary
+} FramePacer;
+
+// Set up a pacer (Pacer, Target FPS (0 = uncapped), Log label)
+void frame_pacer_init(FramePacer* pacer, double fps, const char* name);
+// Wait for the next wake time; counts it when the frame that just ended missed its deadline
+void frame_pacer_wait(FramePacer* pacer);
+// Re-anchor the deadline to now, e.g. after an intentional pause (Pacer)
+void frame_pacer_reset(FramePacer* pacer);
+// Print frame / missed totals and the worst miss (Pacer)
+void frame_pacer_summary(const FramePacer* pacer);
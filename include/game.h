@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    float x, y;
+    float w, h;
+} Paddle;
+
+typedef struct {
+    float x, y;
+    float radius;
+    float vx, vy;
+} Ball;
+
+/* Q16.16 fixed point, for the optional integer-only physics core. Every operation on
+   it is integer arithmetic with a defined result, so a match stepped this way comes
+   out bit for bit the same on any compiler, flags or CPU (lockstep, replay checks). */
+typedef int32_t Fixed;
+#define FIXED_ONE (1 << 16)
+
+typedef struct {
+    Fixed x, y;
+    Fixed w, h;
+} FixedPaddle;
+
+typedef struct {
+    Fixed x, y;
+    Fixed radius;
+    Fixed vx, vy;
+} FixedBall;
+
+// Button bits fed to game_step
+#define INPUT_LEFT_UP    (1u << 0)
+#define INPUT_LEFT_DOWN  (1u << 1)
+#define INPUT_RIGHT_UP   (1u << 2)
+#define INPUT_RIGHT_DOWN (1u << 3)
+#define INPUT_BOTTOM_LEFT  (1u << 4)
+#define INPUT_BOTTOM_RIGHT (1u << 5)
+#define INPUT_TOP_LEFT     (1u << 6)
+#define INPUT_TOP_RIGHT    (1u << 7)
+
+#define GAME_MAX_PLAYERS 4
+
+// Paddle sides, also the order of last_hit
+enum { SIDE_LEFT, SIDE_RIGHT, SIDE_BOTTOM, SIDE_TOP };
+
+struct Court;
+
+/* Everything the simulation owns. Plain data so it can be copied into snapshots.
+   With 3 players the bottom wall gets a paddle, with 4 the top one too; an unguarded
+   wall bounces the ball. Two players score the classic way, when the ball gets past
+   the other side; with more, whoever touched the ball last scores when it gets past
+   anyone else. */
+typedef struct {
+    Paddle left, right;
+    Paddle bottom, top;    // Lie along the wall, move left / right
+    Ball ball;
+    int left_points, right_points;
+    int bottom_points, top_points;
+    int players;           // 2..GAME_MAX_PLAYERS
+    int last_hit;          // SIDE_* of the last paddle the ball bounced off, -1 since the serve
+
+    uint32_t rng;          // xorshift32 state for serves
+    uint32_t serves;       // Bumped on every reset, so interpolation can skip teleports
+    uint32_t paddle_hits;  // Bumped on every paddle bounce, so effects can spot them
+    uint64_t tick;
+    uint64_t time_ns;      // When this tick was simulated
+    unsigned input_event;  // Latest latency-test event consumed (0 = none)
+    const struct Court* court;   // Static obstacles, or NULL; shared and never written
+
+    int fixed_point;       // 1 = stepped on the Q16.16 bodies below, the float ones are copied from them
+    struct {
+        FixedPaddle left, right, bottom, top;
+        FixedBall ball;
+    } fixed;
+} GameState;
+
+// Set up a fresh two-player match (State, RNG Seed)
+void game_init(GameState* state, uint32_t seed);
+// Change the player count of a fresh match, clamped to 2..GAME_MAX_PLAYERS (State, Players)
+void game_set_players(GameState* state, int players);
+// Switch a fresh match to the fixed-point core; it has no obstacle sweeps, so the court is ignored (State, 1 = fixed point)
+void game_set_fixed_point(GameState* state, int fixed_point);
+// Advance one fixed tick (State, INPUT_* bits held this tick)
+void game_step(GameState* state, unsigned buttons);
+// Move and clamp the paddles for one tick; part of game_step (State, INPUT_* bits held this tick)
+void game_move_paddles(GameState* state, unsigned buttons);
+// Bounce the ball off the left or right paddle if they touch; returns 1 if it bounced (Ball, Paddle, 1 = left paddle / 0 = right)
+int game_bounce_paddle(Ball* ball, const Paddle* paddle, int left);
+// Blend two ticks for display; serves / scores come from b (Output, Older, Newer, 0..1)
+void game_lerp(GameState* out, const GameState* a, const GameState* b, float t);
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+/* Entry points above GL 1.1, loaded at runtime through glfwGetProcAddress.
+   Every group has a has_* flag; callers must check it and fall back. */
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE   0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT      0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED              0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED                  0x911D
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER                 0x8892
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW                  0x88E0
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER            0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ                  0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY                    0x88B8
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT                0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT           0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT             0x0080
+#endif
+
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER              0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER                0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS               0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS                  0x8B82
+#endif
+
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER                  0x8D40
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0            0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE         0x8CD5
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE                0x812F
+#endif
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED                 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT                 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE       0x8867
+#endif
+
+#include <stddef.h>
+
+typedef void* GLExtSync;
+
+typedef struct {
+    int has_sync;
+    GLExtSync (*fence_sync)(GLenum condition, GLbitfield flags);
+    GLenum (*client_wait_sync)(GLExtSync sync, GLbitfield flags, unsigned long long timeout);
+    void (*delete_sync)(GLExtSync sync);
+
+    // Vertex buffer objects (GL 1.5)
+    int has_vbo;
+    void (*gen_buffers)(GLsizei n, GLuint* buffers);
+    void (*delete_buffers)(GLsizei n, const GLuint* buffers);
+    void (*bind_buffer)(GLenum target, GLuint buffer);
+    void (*buffer_data)(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+
+    // Pixel buffer objects (GL 2.1 / ARB_pixel_buffer_object); uses the VBO entry points too
+    int has_pbo;
+    void* (*map_buffer)(GLenum target, GLenum access);
+    GLboolean (*unmap_buffer)(GLenum target);
+
+    // Framebuffer objects (GL 3.0 / ARB_framebuffer_object, or the EXT_framebuffer_object names)
+    int has_fbo;
+    void (*gen_framebuffers)(GLsizei n, GLuint* framebuffers);
+    void (*delete_framebuffers)(GLsizei n, const GLuint* framebuffers);
+    void (*bind_framebuffer)(GLenum target, GLuint framebuffer);
+    void (*framebuffer_texture_2d)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+    GLenum (*check_framebuffer_status)(GLenum target);
+
+    // GPU timer queries (GL 3.3 / ARB_timer_query, or EXT_timer_query)
+    int has_timer_query;
+    void (*gen_queries)(GLsizei n, GLuint* ids);
+    void (*delete_queries)(GLsizei n, const GLuint* ids);
+    void (*begin_query)(GLenum target, GLuint id);
+    void (*end_query)(GLenum target);
+    void (*get_query_objectiv)(GLuint id, GLenum pname, GLint* param);
+    void (*get_query_objectui64v)(GLuint id, GLenum pname, unsigned long long* param);
+
+    // Immutable storage + persistent mapping (GL 4.4 / ARB_buffer_storage)
+    int has_buffer_storage;
+    void (*buffer_storage)(GLenum target, ptrdiff_t size, const void* data, GLbitfield flags);
+    void* (*map_buffer_range)(GLenum target, ptrdiff_t offset, ptrdiff_t length, GLbitfield access);
+
+    // GLSL programs (GL 2.0)
+    int has_shaders;
+    GLuint (*create_shader)(GLenum type);
+    void (*shader_source)(GLuint shader, GLsizei count, const char* const* source, const GLint* length);
+    void (*compile_shader)(GLuint shader);
+    void (*get_shaderiv)(GLuint shader, GLenum pname, GLint* param);
+    void (*get_shader_info_log)(GLuint shader, GLsizei size, GLsizei* length, char* log);
+    void (*delete_shader)(GLuint shader);
+    GLuint (*create_program)(void);
+    void (*delete_program)(GLuint program);
+    void (*attach_shader)(GLuint program, GLuint shader);
+    void (*link_program)(GLuint program);
+    void (*get_programiv)(GLuint program, GLenum pname, GLint* param);
+    void (*get_program_info_log)(GLuint program, GLsizei size, GLsizei* length, char* log);
+    void (*use_program)(GLuint program);
+    GLint (*get_uniform_location)(GLuint program, const char* name);
+    void (*uniform1i)(GLint location, GLint value);
+    GLint (*get_attrib_location)(GLuint program, const char* name);
+    void (*vertex_attrib_pointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+    void (*enable_vertex_attrib_array)(GLuint index);
+    void (*disable_vertex_attrib_array)(GLuint index);
+
+    // Instanced drawing (GL 3.3, or ARB_draw_instanced + ARB_instanced_arrays); needs has_shaders
+    int has_instancing;
+    void (*draw_arrays_instanced)(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+    void (*vertex_attrib_divisor)(GLuint index, GLuint divisor);
+} GLExt;
+
+extern GLExt gl_ext;
+
+// Load extension entry points for the current context (call after glfwMakeContextCurrent)
+void gl_ext_load(void);
+// Compile and link a program; returns 0 and logs on failure (Vertex source or NULL, Fragment source)
+GLuint gl_ext_build_program(const char* vertex_source, const char* fragment_source);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+/* Shadow copy of the fixed-function state we touch every frame.
+   All binds / toggles / colors go through these wrappers so redundant ones are dropped.
+   Anything that changes this state behind the cache's back must call gls_invalidate(). */
+
+typedef struct {
+    unsigned issued;   // Calls that reached GL this frame
+    unsigned elided;   // Calls dropped as redundant this frame
+    unsigned long long total_issued;
+    unsigned long long total_elided;
+    unsigned long long frames;
+} GLStateStats;
+
+extern GLStateStats gls_stats;
+extern int gls_debug;   // Print the per-frame counters (--gl-stats)
+
+// Forget everything we know; the next call of each kind is always issued
+void gls_invalidate(void);
+// Forget the current color only (it is undefined after drawing with a color array)
+void gls_invalidate_color(void);
+
+void gls_bind_texture(GLuint texture);
+void gls_enable(GLenum cap);
+void gls_disable(GLenum cap);
+void gls_blend_func(GLenum src, GLenum dst);
+void gls_color4f(float r, float g, float b, float a);
+void gls_use_program(GLuint program);
+void gls_alpha_func(GLenum func, float ref);
+
+// Remember the program / alpha test a texture has to be drawn with (Texture, Program or 0, Alpha test reference or 0 for none)
+void gls_register_texture(GLuint texture, GLuint program, float alpha_ref);
+// Everything needed to draw with a texture (0 = untextured)
+void gls_texture_state(GLuint texture);
+
+// Roll the per-frame counters over (call once per swap)
+void gls_frame_end(void);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+
+/* On-demand glyphs from a TrueType font. A glyph is rasterized the first time it is
+   asked for, turned into a distance field and packed onto one of a few atlas pages;
+   after that every lookup is a hash probe. When all pages are full the least recently
+   used page is wiped and refilled. */
+
+#define GLYPH_PAGE_SIZE 512
+#define GLYPH_PAGES     4
+#define GLYPH_LINE_PX   48.0f   // Raster size of one line; the distance field scales from there
+#define GLYPH_PAD       4       // Empty border around each glyph, also the distance field spread
+
+typedef struct {
+    uint32_t codepoint;
+    int page;                        // -1 = nothing to draw (e.g. space)
+    GLuint texture;
+    float u0, v0, u1, v1;
+    float left, top, width, height;  // Quad relative to pen / baseline, in line heights
+    float advance;                   // In line heights
+} CachedGlyph;
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;       // Each one is a rasterization
+    unsigned long long evictions;    // Pages wiped
+} GlyphCacheStats;
+
+extern GlyphCacheStats glyph_cache_stats;
+
+// Open the font and create the atlas pages; returns 0 if the font can't be used (TTF path)
+int glyph_cache_init(const char* ttf_path);
+// Same, for a font already in memory (e.g. the asset pack); data must stay valid
+int glyph_cache_init_memory(const unsigned char* data, uint32_t size);
+void glyph_cache_shutdown(void);
+int glyph_cache_active(void);
+// Baseline offset below the top of a line, in line heights
+float glyph_cache_ascent(void);
+// Look up (rasterizing on a miss) a code point; NULL when no font is loaded
+const CachedGlyph* glyph_cache_get(uint32_t codepoint);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "scene.h"
+
+#include <GLFW/glfw3.h>
+
+/* Instanced quads: one unit quad drawn once per queued instance by a single
+   glDrawArraysInstanced, whatever the count. Each instance is a rectangle, a colour and
+   (for glyphs) a cell of the shared font atlas, so rectangles and text mix in one call
+   and keep their queue order. Needs GLSL plus instanced arrays; callers check
+   instancing_active() and fall back to draw_rectangle / draw_text. */
+
+typedef struct {
+    float rect[4];           // x0, y0, x1, y1 in -1..1
+    float uv[4];             // u0, v0, u1, v1 into the font atlas; negative = untextured
+    unsigned char color[4];
+} QuadInstance;
+
+typedef struct {
+    unsigned instances;      // Instances drawn this frame
+    unsigned draws;          // Instanced draw calls this frame
+} InstancingStats;
+
+extern InstancingStats instancing_stats;
+
+// Build the program and buffers; returns 0 (and stays off) without support
+int instancing_init(void);
+void instancing_shutdown(void);
+int instancing_active(void);
+
+// Queue a rectangle (Bottom-left X, Y, Width, Height; Red, Green, Blue, Alpha)
+void instance_rect(float x, float y, float w, float h, float r, float g, float b, float a);
+// Queue ASCII text with its top-left at x, y, like draw_text (Text, X-Position, Y-Position, Size)
+void instance_text(const char* text, float x, float y, float size);
+// Queue a whole scene, text centred as draw_scene does (Scene)
+void instance_scene(const Scene* scene);
+// Draw everything queued in one call
+void instancing_flush(void);
+// Roll the per-frame stats (call once per swap)
+void instancing_end_frame(void);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdio.h>
+
+/* Input-to-present latency test (--latency-test).
+   A background thread injects synthetic key presses at random moments. Each one
+   is followed through input sampling, simulation, draw submission and present. */
+
+// Start injecting events; 0 if the sample buffer or the injector thread can't be set up (Number of samples to collect)
+int latency_start(int samples);
+void latency_stop(void);
+int latency_enabled(void);
+int latency_done(void);
+
+// Returns 1 while an injected press of key is waiting to be sampled (GLFW Key)
+int latency_key_down(int key);
+// Id of the event the input code has sampled but the simulation has not applied yet, else 0
+unsigned latency_sampled_event(void);
+
+// Advance the in-flight event; ignored unless it is the current one (Event id)
+void latency_mark_sim(unsigned event);
+void latency_mark_submit(unsigned event);
+// Wait for the swap to complete (fence sync, else glFinish) and stamp the present
+void latency_wait_present(void);
+
+// Print min / median / p99 for every stage (Output stream)
+void latency_report(FILE* out);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "game.h"
+
+#include <stdint.h>
+
+/* Multi-ball mode: thousands of balls on one court, bouncing off the walls, the
+   paddles and each other. Balls are kept as separate arrays per field (structure of
+   arrays) so the per-tick loops stream through memory. Ball-ball contacts go through a
+   uniform grid with cells at least one ball wide, rebuilt every tick with a counting
+   sort (count per cell, prefix sum, scatter), so each ball only checks the 3x3 cells
+   around it and a tick stays close to linear in the ball count. */
+
+typedef struct {
+    int count;
+    float radius;            // Shared by every ball
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+
+    int grid_cols, grid_rows;
+    float cell_size;
+    int* cell_start;         // First entry of each cell in cell_balls; grid_cols * grid_rows + 1
+    int* cell_balls;         // Ball indices sorted by cell
+    int* ball_cell;          // Cell of each ball this tick
+
+    uint32_t rng;
+    unsigned long long pair_tests;   // Ball pairs checked, since init
+    unsigned long long contacts;     // Ball pairs that bounced, since init
+} MultiBall;
+
+// Allocate and serve count balls; returns 0 on allocation failure (Field, Ball count, Radius (0 = fit the count), RNG Seed)
+int multiball_init(MultiBall* field, int count, float radius, uint32_t seed);
+void multiball_free(MultiBall* field);
+// Advance one fixed tick: paddles from the buttons, then every ball; points go to the court (Field, Court, INPUT_* bits)
+void multiball_step(MultiBall* field, GameState* court, unsigned buttons);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Fixed-capacity particle pool for hit sparks and score bursts. Every field lives in
+   its own array inside the pool (structure of arrays), so the update is a few 4-wide
+   SIMD passes and emitting never allocates. Two hard caps keep a frame's cost bounded:
+   PARTICLE_CAPACITY live particles, and PARTICLE_FRAME_BUDGET new ones per frame. Past
+   half full, bursts shrink with the free space left, so a flurry of hits thins out the
+   effects smoothly rather than cutting them off. */
+
+#define PARTICLE_CAPACITY     4096    // Multiple of 4, for the SIMD passes
+#define PARTICLE_FRAME_BUDGET 768     // New particles per particles_update
+
+typedef struct {
+    int count;
+    int emitted;                      // Since the last particles_update
+    uint32_t rng;
+    unsigned long long trimmed;       // Asked for but cut by the caps, since init
+
+    _Alignas(16) float x[PARTICLE_CAPACITY];
+    _Alignas(16) float y[PARTICLE_CAPACITY];
+    _Alignas(16) float vx[PARTICLE_CAPACITY];
+    _Alignas(16) float vy[PARTICLE_CAPACITY];
+    _Alignas(16) float life[PARTICLE_CAPACITY];    // Seconds left
+    _Alignas(16) float fade[PARTICLE_CAPACITY];    // 1 / starting life, so alpha = life * fade
+    uint32_t color[PARTICLE_CAPACITY];              // RGB bytes, red lowest
+} ParticlePool;
+
+// Empty the pool (Pool, RNG Seed)
+void particles_init(ParticlePool* pool, uint32_t seed);
+// Fan of sparks thrown along a direction; returns how many were emitted (Pool, X, Y, Direction X, Y, Count; Red, Green, Blue)
+int particles_sparks(ParticlePool* pool, float x, float y, float dx, float dy, int count, float r, float g, float b);
+// Ring burst in every direction; returns how many were emitted (Pool, X, Y, Count; Red, Green, Blue)
+int particles_burst(ParticlePool* pool, float x, float y, int count, float r, float g, float b);
+// Advance every particle, drop the dead ones and open the next frame's budget (Pool, Seconds)
+void particles_update(ParticlePool* pool, float dt);
@@ -0,0 +1,23 @@
+#pragma once
+
+/* PNG decoder for the common asset case: 8 bits per channel, not interlaced, grey,
+   grey + alpha, RGB, RGBA or palette. It inflates the image data straight into one
+   buffer of the exact size (64-bit bit buffer, 10-bit Huffman lookup, 8-byte match
+   copies) and undoes the row filters with SSE2 for 3 and 4 byte pixels, plain C
+   elsewhere. Anything else (16-bit, interlaced, colour-keyed tRNS, a stream it
+   doesn't like) goes to stb_image, so every PNG stbi_load reads still loads.
+   Output is always RGBA8, allocated through the decode arena hooks (decode_arena.h),
+   so free it with decode_free / stbi_image_free. */
+
+typedef struct {
+    const unsigned char* file;   // Whole PNG file, and its size in bytes
+    int size;
+    unsigned char* pixels;       // RGBA8, NULL if it couldn't be decoded
+    int width, height;
+} PngJob;
+
+// Decode a PNG in memory to RGBA8; NULL on failure (File bytes, Size, Output width, height)
+unsigned char* png_decode(const unsigned char* file, int size, int* width, int* height);
+
+// Decode every job, one image per worker; the calling thread works too (Jobs, Count, Threads, 0 = one per core)
+void png_decode_batch(PngJob* jobs, int count, int threads);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdio.h>
+
+/* Render stress benchmark (--render-bench): the same rectangles or glyphs drawn through
+   each submission path at each count, a few warm-up frames and then up to
+   BENCH_FRAMES measured ones (fewer once a case has taken BENCH_CASE_SECONDS).
+   Per frame it records CPU submit time (first draw call to last flush), GPU time (timer
+   query around the same span, when available), frame time (frame start to frame start,
+   swap and GPU wait included) and draw calls. The caller does the drawing and swapping. */
+
+typedef enum {
+    BENCH_IMMEDIATE,         // glBegin / glEnd per item
+    BENCH_BATCHED,           // Streaming vertex ring
+    BENCH_INSTANCED,         // One instanced draw
+    BENCH_PATH_COUNT
+} BenchPath;
+
+typedef enum {
+    BENCH_RECTS,             // draw_rectangle / instance_rect
+    BENCH_GLYPHS,            // draw_char / instance_text
+    BENCH_WORKLOAD_COUNT
+} BenchWorkload;
+
+typedef struct {
+    BenchPath path;
+    BenchWorkload workload;
+    int count;               // Items per frame
+} BenchCase;
+
+// Plan every path / workload / count; returns 0 on a bad list or no memory (Up to 16 comma-separated counts or NULL for 1k..1M, 1 << BenchPath bits usable)
+int render_bench_start(const char* counts, unsigned paths);
+// Case the next frame should draw; returns 0 once every case is done (Output)
+int render_bench_case(BenchCase* out);
+// Before the first draw call of a frame
+void render_bench_frame_begin(void);
+// After the last flush of a frame, before the swap (Draw calls issued)
+void render_bench_submitted(unsigned draws);
+// After the swap; collects the GPU time and moves on when the case has enough frames
+void render_bench_frame_end(void);
+// Table of medians / p95s per case (Output)
+void render_bench_report(FILE* out);
+void render_bench_stop(void);
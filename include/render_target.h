@@ -0,0 +1,36 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+/* Offscreen target at a fixed internal resolution.
+   Every frame is drawn into a framebuffer object of render_width x render_height and
+   upscaled onto the window in one textured quad at swap time, letterboxed to keep the
+   aspect ratio. Fill cost is then set by the internal size, not by the window or the
+   display's pixel density. The drawn region can shrink below the internal size at runtime
+   (render_target_set_scale) without reallocating anything. Without FBO support frames
+   draw straight to the window, still letterboxed. */
+
+typedef struct {
+    int width, height;              // Internal resolution
+    int window_width, window_height; // Window framebuffer, in pixels
+    int view_x, view_y, view_w, view_h; // Letterboxed rectangle the frame is presented into
+    int offscreen;                  // 1 = FBO path, 0 = direct fallback
+    float scale;                    // Fraction of the internal size actually drawn (dynamic resolution)
+    int scaled_width, scaled_height; // Drawn region, bottom-left of the target
+} RenderTarget;
+
+extern RenderTarget render_target;
+
+// Create the target (Internal width, height; Window framebuffer width, height)
+int render_target_init(int width, int height, int window_width, int window_height);
+void render_target_shutdown(void);
+// The window framebuffer changed size; hook up to glfwSetFramebufferSizeCallback (Width, Height)
+void render_target_resize(int window_width, int window_height);
+// Draw only a scale x scale fraction of the target and stretch that at present; offscreen only (Scale, 0..1]
+void render_target_set_scale(float scale);
+// Point drawing at the target; called by init and after every present
+void render_target_begin(void);
+// Upscale the finished frame onto the window (call right before glfwSwapBuffers)
+void render_target_present(void);
+// Map a window framebuffer position to the game's -1..1 coordinates (Pixel X, Pixel Y, Out X, Out Y)
+void render_target_to_ndc(float pixel_x, float pixel_y, float* x, float* y);
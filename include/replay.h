@@ -0,0 +1,59 @@
+#pragma once
+
+#include "court.h"
+#include "game.h"
+
+#include <stdint.h>
+
+/* Input log for a match. game_step is deterministic for a seed and the buttons of
+   every tick, so a replay only stores the seed and each tick the buttons changed on;
+   re-simulating it reproduces the match exactly.
+   File layout: ReplayHeader, then event_count ReplayEvents in tick order. Version 1
+   headers end before players and are two-player matches; they still load. */
+
+#define REPLAY_MAGIC   0x50525050u   // "PPRP" little-endian
+#define REPLAY_VERSION 2
+
+#define REPLAY_FIXED_POINT (1u << 0)  // ReplayHeader flags: stepped on the fixed-point core
+#define REPLAY_MAX_TICKS   (1ull << 24)   // Longest match a file may claim: 77 hours at 60 Hz, 4.6 at 1 kHz
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;
+    uint32_t event_count;
+    double tick_rate;
+    uint64_t end_tick;       // Ticks simulated in total
+    uint32_t players;        // Version 2 on
+    uint32_t flags;          // REPLAY_* bits, 0 in files from before they existed
+} ReplayHeader;
+
+typedef struct {
+    uint64_t tick;           // First tick these buttons were held on
+    uint32_t buttons;        // INPUT_* bits
+    uint32_t reserved;
+} ReplayEvent;
+
+typedef struct {
+    uint32_t seed;
+    int players;             // 2 after replay_init; set it before recording a bigger match
+    int fixed_point;         // Same, for a match on the fixed-point core
+    double tick_rate;
+    uint64_t end_tick;
+    ReplayEvent* events;
+    uint32_t count, capacity;
+} Replay;
+
+// Start an empty recording (Replay, RNG Seed, Ticks per second)
+void replay_init(Replay* replay, uint32_t seed, double tick_rate);
+void replay_free(Replay* replay);
+// Note the buttons used for a tick; only changes are stored (Replay, Tick, INPUT_* bits)
+void replay_record(Replay* replay, uint64_t tick, unsigned buttons);
+// Returns 0 on I/O errors or a malformed file, including one longer than REPLAY_MAX_TICKS (Replay, File path)
+int replay_save(const Replay* replay, const char* path);
+int replay_load(Replay* replay, const char* path);
+// Buttons held on a tick; walk ticks in order with the same cursor, starting at 0 (Replay, Tick, Cursor)
+unsigned replay_buttons(const Replay* replay, uint64_t tick, uint32_t* cursor);
+// Re-simulate the whole match, with the replay's player count and physics core; states[i] is the state after i ticks, end_tick + 1 entries
+// The court isn't stored in the file; pass the one the match was played on (Replay, Court or NULL, Output)
+void replay_simulate(const Replay* replay, const Court* court, GameState* states);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "game.h"
+
+/* What a gameplay frame shows, as plain data: coloured rectangles then text, in draw
+   order, in the game's -1..1 coordinates. The window draws it through GL and the offline
+   tools rasterize the same list on the CPU, so both always show the same picture. */
+
+#define SCENE_MAX_RECTS 256  // Room for a court's obstacles
+#define SCENE_MAX_TEXTS 8
+#define SCENE_TEXT_SIZE 0.18f   // Score size; same as the menu button text
+
+typedef struct {
+    float x, y, w, h;        // Bottom-left corner and size
+    float r, g, b, a;
+} SceneRect;
+
+typedef struct {
+    char text[16];
+    float x, y;              // Top centre
+    float size;
+} SceneText;
+
+typedef struct {
+    float background[3];
+    SceneRect rects[SCENE_MAX_RECTS];
+    int rect_count;
+    SceneText texts[SCENE_MAX_TEXTS];
+    int text_count;
+} Scene;
+
+// Obstacles, paddles, ball and scores for a state (Scene, State)
+void scene_game(Scene* scene, const GameState* state);
+// Squeeze a scene's -1..1 area into a tile of the screen; text shrinks with it (Scene, Bottom-left X, Y, Width, Height)
+void scene_fit(Scene* scene, float x, float y, float w, float h);
@@ -0,0 +1,20 @@
+#pragma once
+
+/* Distance field atlas for font.png. No GL in here, so the asset packer can bake it offline. */
+
+#include <stdint.h>
+
+#define FONT_COLS   16
+#define FONT_ROWS   6
+#define FONT_CELL_W 8
+#define FONT_CELL_H 12
+#define SDF_SCALE   2     // SDF texels per source pixel: 256 x 144 x 1 byte, the size of the old 128 x 72 RGBA atlas
+#define SDF_SPREAD  4.0f  // Distance (in SDF texels) covered by the 0..1 range
+#define SDF_OUTLINE (SDF_SCALE / (2.0f * SDF_SPREAD))   // Field drop across font.png's 1 px outline; its silhouette is at 0.5 - this
+
+// Cell index of a character in font.png, -1 if it isn't there
+int font_index(uint32_t c);
+// Atlas rectangle of a character as u0, v0 (top), u1, v1 (bottom); returns 0 if it isn't there (Character, Output)
+int font_cell_uv(uint32_t c, float uv[4]);
+// Build the one-channel SDF atlas of the white fill from RGBA pixels; the outline is the SDF_OUTLINE band around it. NULL if out of memory
+unsigned char* build_sdf_atlas(const unsigned char* rgba, int width, int height);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "court.h"
+#include "game.h"
+#include "replay.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Runs game_step on its own thread at a fixed tick rate and publishes each tick
+   through a lock-free triple buffer. The render thread only ever reads the newest
+   completed snapshot, so neither side waits on the other. */
+
+typedef struct {
+    GameState slots[3];
+    atomic_uint middle;   // Slot index shared between the threads, | SNAPSHOT_FRESH when unread
+    unsigned back;        // Slot the sim thread writes (sim thread only)
+    unsigned front;       // Slot the render thread reads (render thread only)
+} SnapshotBuffer;
+
+typedef struct {
+    SnapshotBuffer snapshots;
+    GameState state;          // Working state (sim thread only)
+    GameState prev, latest;   // Last two snapshots seen (render thread only)
+
+    atomic_uint held;         // INPUT_* bits currently held
+    atomic_uint pressed;      // Bits pressed since the last tick, so short taps are not lost
+    atomic_uint input_event;  // Latency-test event riding along with the input
+    atomic_int paused;
+    atomic_int running;
+
+    double tick_rate;
+    Replay* record;           // Every tick's buttons go here when set (sim thread only)
+    pthread_t thread;
+} Simulation;
+
+// Start the sim thread paused; returns 0 if the thread could not be created (Simulation, Ticks per second, RNG Seed, Players, 1 = fixed-point core, Obstacles or NULL, Replay to record into or NULL)
+int sim_start(Simulation* sim, double tick_rate, uint32_t seed, int players, int fixed_point, const Court* court, Replay* record);
+// Stop and join the thread; only after a successful sim_start (Simulation)
+void sim_stop(Simulation* sim);
+void sim_set_paused(Simulation* sim, int paused);
+// Publish input sampled on the main thread (Simulation, INPUT_* bits, Latency event or 0)
+void sim_set_input(Simulation* sim, unsigned buttons, unsigned event);
+// Newest state, blended between the last two ticks and delayed by one tick (Simulation, Output)
+void sim_view(Simulation* sim, GameState* out);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "scene.h"
+
+/* CPU rasterizer for Scene, for tools that render without a GL context.
+   Follows GL's rules where they show: a pixel is covered when its centre is inside a
+   rectangle, and alpha blends as SRC_ALPHA / ONE_MINUS_SRC_ALPHA. Text samples font.png
+   directly (nearest), which is what the distance field atlas reproduces on screen.
+   Every call only touches its own canvas, so canvases can be drawn on different
+   threads at once. */
+
+typedef struct {
+    int width, height;
+    unsigned char* rgba;     // Rows top-down
+} SoftCanvas;
+
+typedef struct {
+    const unsigned char* rgba;   // font.png as RGBA, FONT_COLS x FONT_ROWS cells
+    int width, height;
+} SoftFont;
+
+// Fill the canvas (Canvas; Red, Green, Blue)
+void soft_clear(SoftCanvas* canvas, float r, float g, float b);
+// Blend a rectangle given in -1..1 coordinates (Canvas, Bottom-left X, Y, Width, Height; Red, Green, Blue, Alpha)
+void soft_rect(SoftCanvas* canvas, float x, float y, float w, float h, float r, float g, float b, float a);
+// ASCII text with its top-left at x, y, like draw_text (Canvas, Font, Text, X-Position, Y-Position, Size)
+void soft_text(SoftCanvas* canvas, const SoftFont* font, const char* text, float x, float y, float size);
+// Clear to the scene background and draw everything in it (Canvas, Font, Scene)
+void soft_draw_scene(SoftCanvas* canvas, const SoftFont* font, const Scene* scene);
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdio.h>
+
+/* Startup breakdown (--startup-report). Each mark closes a stage that began at the
+   previous mark; the first stage begins at process start where the OS can tell us,
+   otherwise at main. Marks cost nothing until the report is enabled. */
+
+// Start timing; call first thing in main
+void startup_begin(void);
+void startup_enable(void);
+int startup_enabled(void);
+// The stage that just finished (Name, kept as a pointer)
+void startup_mark(const char* stage);
+// Stage times, their share and the running total (Output stream)
+void startup_report(FILE* out);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+
+/* Bitmap font text. font.png is a 16x6 grid of 8x12 glyphs; at load time it is turned
+   into a signed distance field atlas so one small texture stays sharp at every size.
+   Strings are UTF-8: anything font.png lacks comes from the TrueType glyph cache. */
+
+#include "asset_pack.h"
+#include "sdf.h"
+
+extern GLuint font_texture;
+
+// Load font.png and upload it as a distance field atlas (File path)
+void load_font_texture(const char* path);
+// Upload the prebuilt font atlas (and TTF, if packed) straight from an asset pack; 0 if it has none
+int load_font_pack(const AssetPack* pack);
+// Upload an SDF atlas built by build_sdf_atlas (Pixels, Atlas Width, Atlas Height)
+void upload_sdf_atlas(const unsigned char* sdf, int width, int height);
+// Draw a texture through the distance field path (shader or alpha test) (Texture, Silhouette distance past the 0.5 fill edge, 0 = none)
+void register_sdf_texture(GLuint texture, float outline);
+
+// Draw an individual character (Character, X-Position, Y-Position, Size)
+void draw_char(char c, float x, float y, float size);
+// Draw a string of UTF-8 text (Text, X-Position, Y-Position, Size)
+void draw_text(const char* text, float x, float y, float size);
+// Width draw_text would use for a string (Text, Size)
+float text_width(const char* text, float size);
+// Decode one code point and advance the cursor; bad bytes decode as U+FFFD
+uint32_t utf8_next(const char** text);
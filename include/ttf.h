@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Minimal TrueType reader: cmap (formats 4 / 12), simple and composite glyf outlines,
+   hmtx advances. Outlines are flattened and scan-converted with an exact-area accumulator.
+   Every table and glyph read is checked against the font's size, so a truncated or
+   corrupt file loads as nothing or draws blank glyphs instead of reading past the end. */
+
+typedef struct {
+    const unsigned char* data;
+    uint32_t size;
+    int owns_data;
+    uint32_t glyf, loca, hmtx, cmap;   // Table offsets (cmap = chosen subtable)
+    int units_per_em;
+    int ascent, descent;               // hhea, font units
+    int num_glyphs;
+    int num_hmetrics;
+    int long_loca;
+} TTFont;
+
+typedef struct {
+    unsigned char* coverage;   // width * height bytes, row 0 = top (malloc'd)
+    int width, height;
+    float left, top;           // Bitmap origin relative to the pen / baseline, in pixels (top is up)
+    float advance;             // Pen advance in pixels
+} TTGlyphBitmap;
+
+// Load a .ttf file; returns 0 on failure (Font, File path)
+int ttf_load(TTFont* font, const char* path);
+// Use a font already in memory, e.g. mapped from the asset pack; data must outlive the font
+int ttf_load_memory(TTFont* font, const unsigned char* data, uint32_t size);
+void ttf_free(TTFont* font);
+// Glyph index for a Unicode code point (0 = .notdef / missing)
+int ttf_glyph_index(const TTFont* font, uint32_t codepoint);
+// Rasterize a glyph so ascent-descent spans line_px pixels, with pad empty pixels on every side;
+// returns 0, with no coverage, for a corrupt glyph or when out of memory
+int ttf_rasterize(const TTFont* font, int glyph, float line_px, int pad, TTGlyphBitmap* out);
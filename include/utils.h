@@ -1,2 +1,9 @@
+#include <stdint.h>
+
 float clamp(float value, float min, float max);
-// void sleep(int microseconds);
\ No newline at end of file
+uint64_t time_now_ns(void);
+// qsort comparator for uint64_t
+int compare_u64(const void* a, const void* b);
+// Nearest-rank percentile of a sorted array (Sorted values, Count, 0..100)
+uint64_t percentile(const uint64_t* sorted, int n, double p);
+// void sleep(int microseconds);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+/* Streaming vertex ring for per-frame quads.
+   With ARB_buffer_storage the ring is persistently mapped and split into three fenced
+   segments, so quads are written straight into GPU-visible memory and the CPU only
+   waits if it laps the GPU. Without it, quads go into a CPU array that is uploaded
+   with an orphaning glBufferData on every flush. */
+
+typedef struct {
+    float x, y;
+    float u, v;
+    unsigned char r, g, b, a;
+} StreamVertex;
+
+typedef struct {
+    unsigned long bytes;      // Vertex bytes streamed this frame
+    unsigned draws;           // glDrawArrays calls this frame
+    unsigned long long total_bytes;
+    int persistent;           // 1 = mapped ring, 0 = orphaning fallback
+} StreamStats;
+
+extern StreamStats stream_stats;
+
+// Create the ring; returns 0 (and leaves streaming off) without VBO support
+int stream_init(void);
+void stream_shutdown(void);
+int stream_active(void);
+// Flush and make stream_active() report 0 until resumed, so draws go immediate (1 = suspend, 0 = resume)
+void stream_suspend(int suspend);
+
+// Queue a quad from corner (x0, y0) to (x1, y1); texture 0 = untextured
+void stream_quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1,
+    float r, float g, float b, float a, GLuint texture);
+// Re-point the fixed-function arrays at the ring, after a draw that used generic attributes
+void stream_bind_arrays(void);
+// Draw everything queued so far (call before any immediate-mode drawing)
+void stream_flush(void);
+// Flush, fence the frame's region and roll the per-frame stats (call once per swap)
+void stream_end_frame(void);
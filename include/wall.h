@@ -0,0 +1,39 @@
+#pragma once
+
+#include "game.h"
+#include "replay.h"
+#include "scene.h"
+
+#include <stdint.h>
+
+/* Spectator wall: many independent matches ticking side by side in a grid of tiles.
+   Courts with a replay re-simulate it (and start over when it ends); the rest are
+   played by a simple bot on both sides. All courts step together at the replay tick
+   rate from one accumulator, so a slow frame catches up instead of slowing play. */
+
+typedef struct {
+    GameState state;
+    Replay replay;
+    int has_replay;
+    uint32_t cursor;         // replay_buttons walk position
+    uint32_t seed;
+    float reaction;          // How far off (in x) the bots start chasing the ball
+} WallCourt;
+
+typedef struct {
+    WallCourt* courts;
+    int count;
+    int cols, rows;
+    double tick_rate;
+    uint64_t last_ns;
+    uint64_t accumulator_ns;
+} Wall;
+
+// Set up count courts; the first replay_count replay the given files (Wall, Courts, Replay paths, Replay count)
+// Returns 0 if a replay could not be loaded
+int wall_init(Wall* wall, int count, const char* const* replay_paths, int replay_count);
+void wall_free(Wall* wall);
+// Run every court up to now (Wall, Current time)
+void wall_update(Wall* wall, uint64_t now_ns);
+// Scene for one court, already fitted into its tile (Wall, Court index, Output)
+void wall_scene(const Wall* wall, int index, Scene* scene);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* YUV4MPEG2 output: 4:2:0, full-range BT.601 ("C420jpeg"), which ffmpeg / mpv read
+   directly. Conversion and writing are separate so the conversion can run on worker
+   threads and only the ordered write is serial. */
+
+// Bytes of one converted frame (Width, Height)
+size_t y4m_frame_size(int width, int height);
+// Stream header (Output, Width, Height, Frames per second)
+void y4m_write_header(FILE* out, int width, int height, double fps);
+// RGBA to planar YUV (Pixels, Width, Height, 1 = rows bottom-up as GL returns them, Output of y4m_frame_size bytes)
+void y4m_convert(const unsigned char* rgba, int width, int height, int bottom_up, unsigned char* planes);
+// One converted frame (Output, Planes, Width, Height)
+void y4m_write_frame(FILE* out, const unsigned char* planes, int width, int height);
@@ -1,29 +1,43 @@
 #define GL_SILENCE_DEPRECATION
 
 #include "gl_dummy_bleh.h"
+#include "alloc_check.h"
+#include "asset_pack.h"
+#include "capture.h"
+#include "court.h"
+#include "dynamic_res.h"
+#include "frame_arena.h"
+#include "frame_pacer.h"
+#include "game.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "glyph_cache.h"
+#include "instancing.h"
+#include "latency.h"
+#include "multiball.h"
+#include "particles.h"
+#include "render_bench.h"
+#include "render_target.h"
+#include "replay.h"
+#include "scene.h"
+#include "sim_thread.h"
+#include "startup.h"
+#include "text.h"
+#include "vertex_stream.h"
 #include "utils.h"
+#include "wall.h"
 
 #include <GLFW/glfw3.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <math.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#define FRAME_ARENA_BYTES (64 * 1024)
 
-GLuint font_texture;
-
-typedef struct {
-    float x, y;
-    float w, h;
-} Paddle;
-
-typedef struct {
-    float x, y;
-    float radius;
-    float vx, vy;
-} Ball;
+FramePacer frame_pacer;
+DynamicRes dynamic_res;
 
 typedef struct {
     float x; // Top-Left X Coordinate
@@ -32,32 +46,40 @@ typedef struct {
     float h; // Height
 } Rect;
 
-void load_font_texture(const char* path) {
-    int width, height, channels;
-    unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
-    if (!data) {
-        fprintf(stderr, "Could not load texture: %s\n", path);
-        exit(1);
-    }
-
-    glGenTextures(1, &font_texture);
-    glBindTexture(GL_TEXTURE_2D, font_texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    stbi_image_free(data);
-}
-
 // Clear the window and load background
 void clear(float r, float g, float b, float a) {
     glClearColor(r, g, b, a);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
-// Swap Buffers and poll for event inputs
-void swap_and_poll(GLFWwindow* window) {
+// Swap Buffers, wait for the next frame slot and poll for event inputs (Window, Pacer or NULL)
+void swap_and_poll(GLFWwindow* window, FramePacer* pacer) {
+    instancing_end_frame();
+    stream_end_frame();
+    dynamic_res_frame_end(&dynamic_res);
+    capture_frame();
+    render_target_present();
+    gls_frame_end();
+    alloc_check_pause(1);
     glfwSwapBuffers(window);
+    alloc_check_pause(0);
+    latency_wait_present();
+    if (pacer) frame_pacer_wait(pacer);
+    dynamic_res_frame_begin(&dynamic_res);
+    alloc_check_pause(1);
     glfwPollEvents();
+    alloc_check_pause(0);
+}
+
+// Return if a key is held, including synthetic presses from the latency test (Window, GLFW Key)
+int key_down(GLFWwindow* window, int key) {
+    return glfwGetKey(window, key) == GLFW_PRESS || latency_key_down(key);
+}
+
+// Keep the presented frame fitted to the window (Window, Framebuffer width, height)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    (void)window;
+    render_target_resize(width, height);
 }
 
 // Exit and terminate window process
@@ -68,21 +90,25 @@ void window_exit(GLFWwindow* window) {
 
 // Draw a Triangle (Alpha)
 void draw_triangle(float alpha) {
+    stream_flush();
+    gls_texture_state(0);
     glBegin(GL_TRIANGLES);
-        glColor4f(1.0f, 0.0f, 0.0f, alpha);
+        gls_color4f(1.0f, 0.0f, 0.0f, alpha);
         glVertex2f(-0.5f * (1 + alpha * 0.5f), -0.5f * (1 + alpha * 0.5f));
 
-        glColor4f(0.0f, 1.0f, 0.0f, alpha);
+        gls_color4f(0.0f, 1.0f, 0.0f, alpha);
         glVertex2f(0.5f * (1 + alpha * 0.5f), -0.5f * (1 + alpha * 0.5f));
 
-        glColor4f(0.0f, 0.0f, 1.0f, alpha);
+        gls_color4f(0.0f, 0.0f, 1.0f, alpha);
         glVertex2f(0.0f * (1 + alpha * 0.5f), 0.5f * (1 + alpha * 0.5f));
     glEnd();
 }
 
 // Draw a Rectangle as an outline — border offset (X-Position, Y-Position, Width, Height; Red, Green, Blue, Alpha)
 void draw_rectangle_outline(float x, float y, float w, float h, float r, float g, float b, float a) {
-    glColor4f(r, g, b, a);
+    stream_flush();
+    gls_texture_state(0);
+    gls_color4f(r, g, b, a);
     glBegin(GL_LINE_LOOP);
         glVertex2f(x,         y);
         glVertex2f(x + w,     y);
@@ -93,66 +119,61 @@ void draw_rectangle_outline(float x, float y, float w, float h, float r, float g
 
 // Draw a Rectangle from Rectangle Object (Rect Object; Red, Green, Blue, Alpha)
 void draw_rectangle(Rect rect, float r, float g, float b, float a) {
+    if (stream_active()) {
+        stream_quad(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, 0.0f, 0.0f, 0.0f, 0.0f, r, g, b, a, 0);
+        return;
+    }
+
+    gls_texture_state(0);
     glBegin(GL_TRIANGLES);
-        glColor4f(r, g, b, a); glVertex2f(rect.x, rect.y);
-        glColor4f(r, g, b, a); glVertex2f(rect.x + rect.w, rect.y);
-        glColor4f(r, g, b, a); glVertex2f(rect.x + rect.w, rect.y + rect.h);
+        gls_color4f(r, g, b, a); glVertex2f(rect.x, rect.y);
+        gls_color4f(r, g, b, a); glVertex2f(rect.x + rect.w, rect.y);
+        gls_color4f(r, g, b, a); glVertex2f(rect.x + rect.w, rect.y + rect.h);
 
-        glColor4f(r, g, b, a); glVertex2f(rect.x, rect.y);
-        glColor4f(r, g, b, a); glVertex2f(rect.x + rect.w, rect.y + rect.h);
-        glColor4f(r, g, b, a); glVertex2f(rect.x, rect.y + rect.h);
+        gls_color4f(r, g, b, a); glVertex2f(rect.x, rect.y);
+        gls_color4f(r, g, b, a); glVertex2f(rect.x + rect.w, rect.y + rect.h);
+        gls_color4f(r, g, b, a); glVertex2f(rect.x, rect.y + rect.h);
     glEnd();
 }
 
-// Draw an individual character (Character, X-Position, Y-Position, Size)
-void draw_char(char c, float x, float y, float size) {
-const char font_chars[] =
-    " !\"#$%&'()*+,-./"
-    "0123456789:;<=>?"
-    "@ABCDEFGHIJKLMNO"
-    "PQRSTUVWXYZ[\\]^_"
-    "`abcdefghijklmno"
-    "pqrstuvwxyz{|}~";
-
-    int index = -1;
-    for (int i = 0; font_chars[i]; i++) {
-        if (font_chars[i] == c) {
-            index = i;
-            break;
-        }
+// Draw a gameplay scene; text is centred on its x (Scene)
+void draw_scene(const Scene* scene) {
+    for (int i = 0; i < scene->rect_count; i++) {
+        const SceneRect* rect = &scene->rects[i];
+        draw_rectangle((Rect){rect->x, rect->y, rect->w, rect->h}, rect->r, rect->g, rect->b, rect->a);
     }
-    if (index == -1) return;
-    int cols = 16;
-    int col = index % 16;
-    int row = index / 16;
-
-    float cell_w = 8.0f / 128.0f;
-    float cell_h = 12.0f / 72.0f;
-
-    float u0 = col * cell_w;
-    float v0 = (5 - row) * cell_h;
-    float u1 = u0 + cell_w;
-    float v1 = v0 + cell_h;
-
-    glBindTexture(GL_TEXTURE_2D, font_texture);
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-    glBegin(GL_TRIANGLES);
-        glTexCoord2f(u0, 1.0f - v1); glVertex2f(x, y);                 // Top-Left
-        glTexCoord2f(u1, 1.0f - v1); glVertex2f(x + size, y);          // Top-Right
-        glTexCoord2f(u1, 1.0f - v0); glVertex2f(x + size, y - size);   // Bottom-Right
+    for (int i = 0; i < scene->text_count; i++) {
+        const SceneText* text = &scene->texts[i];
+        draw_text(text->text, text->x - text_width(text->text, text->size) / 2.0f, text->y, text->size);
+    }
+}
 
-        glTexCoord2f(u0, 1.0f - v1); glVertex2f(x, y);                 // Top-Left
-        glTexCoord2f(u1, 1.0f - v0); glVertex2f(x + size, y - size);   // Bottom-Right
-        glTexCoord2f(u0, 1.0f - v0); glVertex2f(x, y - size);          // Bottom-Left
-    glEnd();
+#define PARTICLE_SIZE 0.012f
+
+// Draw every live particle, faded by the life it has left; one instanced or one batched draw (Pool)
+void draw_particles(const ParticlePool* pool) {
+    int instanced = instancing_active();
+    for (int i = 0; i < pool->count; i++) {
+        uint32_t c = pool->color[i];
+        float r = (c & 255) / 255.0f, g = (c >> 8 & 255) / 255.0f, b = (c >> 16 & 255) / 255.0f;
+        float a = pool->life[i] * pool->fade[i];
+        float x = pool->x[i] - PARTICLE_SIZE / 2.0f, y = pool->y[i] - PARTICLE_SIZE / 2.0f;
+        if (instanced) instance_rect(x, y, PARTICLE_SIZE, PARTICLE_SIZE, r, g, b, a);
+        else draw_rectangle((Rect){x, y, PARTICLE_SIZE, PARTICLE_SIZE}, r, g, b, a);
+    }
+    if (instanced) instancing_flush();
 }
 
-// Draw a string of text (Text, X-Position, Y-Position, Size)
-void draw_text(const char* text, float x, float y, float size) {
-    float start = x;
-    for (int i = 0; text[i]; i++) {
-        draw_char(text[i], start, y, size);
-        start += size;
+// Sparks off paddle hits and a burst on every point, spotted from the counters between two views (Pool, Previous view, Current view)
+void spawn_effects(ParticlePool* pool, const GameState* prev, const GameState* view) {
+    if (view->paddle_hits != prev->paddle_hits) {
+        particles_sparks(pool, view->ball.x, view->ball.y, view->ball.vx, view->ball.vy, 24, 1.0f, 0.85f, 0.4f);
+    }
+    // The ball has been served again by now, so the burst goes where it was last seen
+    if (view->serves != prev->serves) {
+        float x = clamp(prev->ball.x, -0.98f, 0.98f), y = clamp(prev->ball.y, -0.98f, 0.98f);
+        particles_burst(pool, x, y, 160, 1.0f, 0.3f, 0.2f);
+        particles_burst(pool, x, y, 64, 1.0f, 1.0f, 1.0f);
     }
 }
 
@@ -165,6 +186,10 @@ int is_mouse_over(Rect rect, float mx, float my) {
 void fade_in_screen(GLFWwindow* window) {
     float counter = -0.5f;
 
+    FramePacer pacer;
+    frame_pacer_init(&pacer, 1000000.0 / 32000.0, "fade_in_screen");
+    pacer.late_latch = 0;
+
     while (!glfwWindowShouldClose(window) && counter < 0.3f) {
         clear(
             clamp(counter, 0.0f, 0.2f), 
@@ -172,9 +197,8 @@ void fade_in_screen(GLFWwindow* window) {
             clamp(counter, 0.0f, 0.2f), 
             1.0f
         );
-        swap_and_poll(window);
+        swap_and_poll(window, &pacer);
         counter += 0.02f;
-        usleep(32000);
     }
 }
 
@@ -184,6 +208,10 @@ void loading_screen(GLFWwindow* window) {
     int fadeIn = 1;
     int loading_done = 0;
 
+    FramePacer pacer;
+    frame_pacer_init(&pacer, 1000000.0 / 25000.0, "loading_screen");
+    pacer.late_latch = 0;
+
     while (!glfwWindowShouldClose(window) && !loading_done) {
         clear(0.2f, 0.2f, 0.2f, 1.0f);
         draw_triangle(alpha);
@@ -195,51 +223,380 @@ void loading_screen(GLFWwindow* window) {
         if (alpha >= 1.0f) {
             fadeIn = 0;
             usleep(1000000);
+            frame_pacer_reset(&pacer);
         }
         if (alpha <= 0.0f && !fadeIn) loading_done = 1;
 
-        swap_and_poll(window);
-        usleep(25000);
+        swap_and_poll(window, &pacer);
     }
     alpha = 1.0f;
 }
 
+// Spectator wall; every court goes into one instanced draw, or two stream batches without instancing (Window, Wall)
+void wall_screen(GLFWwindow* window, Wall* wall) {
+    int escp_last = 1;
+
+    while (!glfwWindowShouldClose(window)) {
+        frame_arena_reset();
+        alloc_check_frame();
+
+        int escp_down = glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS;
+        if (escp_down && !escp_last) break;
+        escp_last = escp_down;
+
+        wall_update(wall, time_now_ns());
+
+        clear(0.05f, 0.05f, 0.05f, 1.0f);
+
+        Scene scene;
+
+        if (instancing_active()) {
+            for (int i = 0; i < wall->count; i++) {
+                wall_scene(wall, i, &scene);
+                instance_scene(&scene);
+            }
+            instancing_flush();
+        } else {
+            /* Rectangles of every court first, then all the text, so the font texture is bound once */
+            for (int i = 0; i < wall->count; i++) {
+                wall_scene(wall, i, &scene);
+                for (int j = 0; j < scene.rect_count; j++) {
+                    const SceneRect* rect = &scene.rects[j];
+                    draw_rectangle((Rect){rect->x, rect->y, rect->w, rect->h}, rect->r, rect->g, rect->b, rect->a);
+                }
+            }
+            for (int i = 0; i < wall->count; i++) {
+                wall_scene(wall, i, &scene);
+                for (int j = 0; j < scene.text_count; j++) {
+                    const SceneText* text = &scene.texts[j];
+                    draw_text(text->text, text->x - text_width(text->text, text->size) / 2.0f, text->y, text->size);
+                }
+            }
+        }
+
+        swap_and_poll(window, &frame_pacer);
+    }
+    alloc_check_end();
+}
+
+// Multi-ball mode; W/S and Up/Down move the paddles, Escape quits (Window, Field)
+void multiball_screen(GLFWwindow* window, MultiBall* field) {
+    GameState court;
+    game_init(&court, 1);
+    uint64_t period = (uint64_t)(1e9 / 60.0);
+    uint64_t last = time_now_ns(), accumulator = 0;
+    int escp_last = 1;
+
+    while (!glfwWindowShouldClose(window)) {
+        frame_arena_reset();
+        alloc_check_frame();
+
+        int escp_down = glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS;
+        if (escp_down && !escp_last) break;
+        escp_last = escp_down;
+
+        unsigned buttons = 0;
+        if (key_down(window, GLFW_KEY_W)) buttons |= INPUT_LEFT_UP;
+        if (key_down(window, GLFW_KEY_S)) buttons |= INPUT_LEFT_DOWN;
+        if (key_down(window, GLFW_KEY_UP)) buttons |= INPUT_RIGHT_UP;
+        if (key_down(window, GLFW_KEY_DOWN)) buttons |= INPUT_RIGHT_DOWN;
+
+        // Same 60 Hz tick as the single ball; a slow frame runs a few ticks to catch up
+        uint64_t now = time_now_ns();
+        accumulator += now - last;
+        last = now;
+        for (int ticks = 0; accumulator >= period && ticks < 4; ticks++) {
+            multiball_step(field, &court, buttons);
+            accumulator -= period;
+        }
+        if (accumulator >= period) accumulator = 0;
+
+        clear(0.2f, 0.2f, 0.2f, 1.0f);
+        float size = field->radius * 2.0f;
+        if (instancing_active()) {
+            instance_rect(court.left.x, court.left.y, court.left.w, court.left.h, 0.1f, 0.7f, 0.2f, 1.0f);
+            instance_rect(court.right.x, court.right.y, court.right.w, court.right.h, 0.1f, 0.2f, 0.7f, 1.0f);
+            for (int i = 0; i < field->count; i++) {
+                instance_rect(field->x[i] - field->radius, field->y[i] - field->radius, size, size, 1.0f, 0.1f, 0.1f, 1.0f);
+            }
+            instancing_flush();
+        } else {
+            draw_rectangle((Rect){court.left.x, court.left.y, court.left.w, court.left.h}, 0.1f, 0.7f, 0.2f, 1.0f);
+            draw_rectangle((Rect){court.right.x, court.right.y, court.right.w, court.right.h}, 0.1f, 0.2f, 0.7f, 1.0f);
+            for (int i = 0; i < field->count; i++) {
+                draw_rectangle((Rect){field->x[i] - field->radius, field->y[i] - field->radius, size, size}, 1.0f, 0.1f, 0.1f, 1.0f);
+            }
+        }
+
+        const char* left_score = frame_printf("%d", court.left_points);
+        const char* right_score = frame_printf("%d", court.right_points);
+        draw_text(left_score, -0.5f - text_width(left_score, SCENE_TEXT_SIZE) / 2.0f, 0.8f, SCENE_TEXT_SIZE);
+        draw_text(right_score, 0.5f - text_width(right_score, SCENE_TEXT_SIZE) / 2.0f, 0.8f, SCENE_TEXT_SIZE);
+
+        swap_and_poll(window, &frame_pacer);
+    }
+    alloc_check_end();
+    fprintf(stderr, "multiball: %d balls, %llu ticks, %.1f pair tests and %.2f contacts per tick\n", field->count,
+        (unsigned long long)court.tick, court.tick ? (double)field->pair_tests / court.tick : 0.0,
+        court.tick ? (double)field->contacts / court.tick : 0.0);
+}
+
+// Render stress benchmark; each case's items go through its path until every case is measured (Window)
+void render_bench_screen(GLFWwindow* window) {
+    BenchCase bench;
+    char glyph[2] = { 0, 0 };
+
+    while (!glfwWindowShouldClose(window) && render_bench_case(&bench)) {
+        clear(0.2f, 0.2f, 0.2f, 1.0f);
+        stream_suspend(bench.path == BENCH_IMMEDIATE);
+        render_bench_frame_begin();
+
+        // A square grid filling the target, so every count covers about the same pixels
+        int cols = (int)ceil(sqrt((double)bench.count));
+        float cell = 2.0f / cols;
+        for (int i = 0; i < bench.count; i++) {
+            float x = -1.0f + (i % cols) * cell;
+            float y = 1.0f - (i / cols) * cell;
+            float shade = (i % 7) / 7.0f;
+            if (bench.workload == BENCH_RECTS) {
+                if (bench.path == BENCH_INSTANCED) instance_rect(x, y - cell * 0.8f, cell * 0.8f, cell * 0.8f, shade, 0.5f, 1.0f - shade, 1.0f);
+                else draw_rectangle((Rect){x, y - cell * 0.8f, cell * 0.8f, cell * 0.8f}, shade, 0.5f, 1.0f - shade, 1.0f);
+            } else {
+                glyph[0] = (char)('A' + i % 26);
+                if (bench.path == BENCH_INSTANCED) instance_text(glyph, x, y, cell);
+                else draw_char(glyph[0], x, y, cell);
+            }
+        }
+
+        unsigned draws = bench.count;   // Immediate: one glBegin / glEnd per item
+        if (bench.path == BENCH_INSTANCED) {
+            instancing_flush();
+            draws = instancing_stats.draws;
+        } else if (bench.path == BENCH_BATCHED) {
+            stream_flush();
+            draws = stream_stats.draws;
+        }
+        render_bench_submitted(draws);
+
+        swap_and_poll(window, NULL);
+        render_bench_frame_end();
+    }
+    stream_suspend(0);
+}
+
 void options_menu(GLFWwindow* window) {
     ;
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    startup_begin();
     float border = 0.01f;
+
+    int latency_samples = 0;
+    int immediate_mode = 0;
+    const char* ttf_path = "font.ttf";
+    const char* pack_path = "assets.pak";
+    int swap_interval = -1;
+    double target_fps = 60.0;
+    int render_width = 500, render_height = 500;
+    float dynamic_min_scale = 0.0f;   // 0 = dynamic resolution off
+    const char* capture_path = NULL;
+    const char* record_path = NULL;
+    const char* court_path = NULL;
+    int players = 2;
+    int fixed_point = 0;
+    int alloc_check_warmup = -1;   // -1 = off
+    int wall_count = 0;
+    int multiball_count = 0;
+    int render_bench = 0;
+    int startup_exit = 0;
+    int startup_reported = 0;
+    const char* render_bench_counts = NULL;
+    const char* wall_replays[64];
+    int wall_replay_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--latency-test") == 0) {
+            latency_samples = 200;
+            if (i + 1 < argc && argv[i + 1][0] != '-') latency_samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--swap-interval") == 0 && i + 1 < argc) {
+            swap_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--immediate") == 0) {
+            immediate_mode = 1;
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            pack_path = argv[++i];
+        } else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+            ttf_path = argv[++i];
+        } else if (strcmp(argv[i], "--gl-stats") == 0) {
+            gls_debug = 1;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            target_fps = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--dynamic-res") == 0) {
+            dynamic_min_scale = 0.5f;
+            if (i + 1 < argc && argv[i + 1][0] != '-') dynamic_min_scale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            players = atoi(argv[++i]);
+            if (players < 2 || players > GAME_MAX_PLAYERS) {
+                fprintf(stderr, "Bad --players %s, expected 2 to %d\n", argv[i], GAME_MAX_PLAYERS);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--alloc-check") == 0) {
+            alloc_check_warmup = 120;
+            if (i + 1 < argc && argv[i + 1][0] != '-') alloc_check_warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--court") == 0 && i + 1 < argc) {
+            court_path = argv[++i];
+        } else if (strcmp(argv[i], "--fixed-point") == 0) {
+            fixed_point = 1;
+        } else if (strcmp(argv[i], "--startup-report") == 0) {
+            startup_enable();
+            if (i + 1 < argc && strcmp(argv[i + 1], "exit") == 0) {
+                startup_exit = 1;
+                i++;
+            }
+        } else if (strcmp(argv[i], "--render-bench") == 0) {
+            render_bench = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') render_bench_counts = argv[++i];
+        } else if (strcmp(argv[i], "--multiball") == 0 && i + 1 < argc) {
+            multiball_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--wall") == 0 && i + 1 < argc) {
+            wall_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--wall-replay") == 0 && i + 1 < argc) {
+            if (wall_replay_count < 64) wall_replays[wall_replay_count++] = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capture_path = argv[++i];
+        } else if (strcmp(argv[i], "--render-size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &render_width, &render_height) != 2 || render_width <= 0 || render_height <= 0) {
+                fprintf(stderr, "Bad --render-size %s, expected WxH\n", argv[i]);
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--latency-test [samples]] [--swap-interval n] [--fps n] [--gl-stats] [--immediate] [--font file.ttf] [--pack file.pak] [--render-size WxH] [--dynamic-res [min scale]] [--capture file.y4m] [--record file.rep] [--players 2-4] [--court file.court] [--fixed-point] [--wall courts] [--wall-replay file.rep]... [--multiball balls] [--render-bench [n,n,...]] [--startup-report [exit]] [--alloc-check [warm-up frames]]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (fixed_point && court_path) {
+        fprintf(stderr, "The fixed-point core has no obstacles; ignoring --court\n");
+        court_path = NULL;
+    }
+    if (capture_path && dynamic_min_scale > 0.0f) {
+        fprintf(stderr, "--capture records at a fixed size; ignoring --dynamic-res\n");
+        dynamic_min_scale = 0.0f;
+    }
+    if (alloc_check_warmup >= 0) {
+        if (alloc_check_available()) alloc_check_enable(alloc_check_warmup);
+        else fprintf(stderr, "--alloc-check needs glibc; ignoring it\n");
+    }
+    frame_arena_init(FRAME_ARENA_BYTES);
+    Court court;
+    court_init(&court);
+    if (court_path && !court_load(&court, court_path)) return -1;
     
     glfwInitHint(GLFW_PLATFORM_COCOA, GLFW_TRUE);
     if (!glfwInit()) {
         fprintf(stderr, "Failed to intialize GLFW");
         return -1;
     }
+    startup_mark("glfwInit");
 
     GLFWwindow* window = glfwCreateWindow(500, 500, "Engine", NULL, NULL);
     if (!window) {
         glfwTerminate();
         return -1;
     }
+    startup_mark("glfwCreateWindow");
 
     glfwMakeContextCurrent(window);
-    glEnable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_ext_load();
+    if (swap_interval >= 0) glfwSwapInterval(swap_interval);
+    startup_mark("context (current + GL entry points)");
+
+    gls_invalidate();
+    gls_enable(GL_BLEND);
+    gls_disable(GL_DEPTH_TEST);
+    gls_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    if (!immediate_mode) {
+        stream_init();
+        instancing_init();
+    }
+    startup_mark("vertex stream + instancing");
 
-    load_font_texture("font.png");
+    // Everything draws at the internal resolution and is scaled onto the window at swap
+    int fb_width, fb_height;
+    glfwGetFramebufferSize(window, &fb_width, &fb_height);
+    render_target_init(render_width, render_height, fb_width, fb_height);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    if (capture_path) capture_start(capture_path, target_fps);
+    startup_mark("render target");
+
+    // Prefer the mapped asset pack; loose files are the fallback for development trees
+    AssetPack pack;
+    int pack_open = asset_pack_open(&pack, pack_path);
+    startup_mark("asset_pack_open");
+    if (!pack_open || !load_font_pack(&pack)) {
+        load_font_texture("font.png");
+        glyph_cache_init(ttf_path);   // Optional; without it only font.png's ASCII set draws
+        startup_mark("glyph_cache_init");
+    }
 
 
     // glfwCreateCursor()
 
-    fade_in_screen(window);
-    loading_screen(window);
-    usleep(1000000);
-
     int should_exit = 0;
     int playing = 0;
+    int status = 0;   // Exit code; setup failures after the window is up still shut down cleanly
+
+    // The benchmark, the wall and the latency test skip the intro screens; they only add dead time
+    if (render_bench) {
+        unsigned paths = 1u << BENCH_IMMEDIATE;
+        if (stream_active()) paths |= 1u << BENCH_BATCHED;
+        if (instancing_active()) paths |= 1u << BENCH_INSTANCED;
+        if (render_bench_start(render_bench_counts, paths)) {
+            if (swap_interval < 0) glfwSwapInterval(0);   // Uncapped unless asked, or vsync hides the differences
+            render_bench_screen(window);
+            render_bench_report(stdout);
+            render_bench_stop();
+        } else {
+            fprintf(stderr, "Could not start --render-bench %s, expected up to 16 counts, e.g. 1000,10000\n", render_bench_counts);
+            status = -1;
+        }
+        should_exit = 1;
+    } else if (multiball_count > 0) {
+        MultiBall field;
+        if (multiball_init(&field, multiball_count, 0.0f, 1)) {
+            frame_pacer_init(&frame_pacer, target_fps, "frame_pacer");
+            multiball_screen(window, &field);
+            multiball_free(&field);
+        }
+        should_exit = 1;
+    } else if (wall_count > 0 || wall_replay_count > 0) {
+        Wall wall;
+        if (wall_init(&wall, wall_count, wall_replays, wall_replay_count)) {
+            frame_pacer_init(&frame_pacer, target_fps, "frame_pacer");
+            wall_screen(window, &wall);
+            wall_free(&wall);
+        }
+        should_exit = 1;
+    } else if (latency_samples > 0) {
+        if (latency_start(latency_samples)) {
+            playing = 1;
+        } else {
+            fprintf(stderr, "Could not start the latency test for %d samples\n", latency_samples);
+            should_exit = 1;
+            status = -1;
+        }
+    } else {
+        fade_in_screen(window);
+        startup_mark("fade_in_screen");
+        loading_screen(window);
+        startup_mark("loading_screen");
+        usleep(1000000);
+        startup_mark("pause after loading");
+    }
 
     int left_down_last_frame = 0;
 
@@ -249,17 +606,34 @@ int main() {
 
     float button_text_size = playButton.h * 0.6f;
 
-    Paddle leftPaddle = {-0.9f, -0.15f, 0.05f, 0.3f};
-    Paddle rightPaddle = {0.85f, -0.15f, 0.05f, 0.3f};
-    Ball ball = {0.0f, 0.0f, 0.03f, (rand() % 2 ? 0.01f : -0.01f), (rand() % 2 ? 0.015f : -0.015f)};
-
-    int left_points = 0; int right_points = 0;
+    // Physics runs on its own thread at the 60 Hz the ball / paddle speeds were tuned for
+    Simulation sim;
+    Replay replay;
+    static ParticlePool particles;   // Fixed size, too big for the stack
+    particles_init(&particles, 1);
+    GameState last_view;
+    int have_last_view = 0;
+    uint64_t last_frame_ns = time_now_ns();
+    replay_init(&replay, 1, 60.0);
+    replay.players = players;
+    replay.fixed_point = fixed_point;
+    // Only the menu / game loop needs the sim; the screens above have already run and set should_exit
+    int sim_running = 0;
+    if (!should_exit) {
+        sim_running = sim_start(&sim, replay.tick_rate, replay.seed, players, fixed_point, court_path ? &court : NULL, record_path ? &replay : NULL);
+        if (!sim_running) {
+            fprintf(stderr, "Could not start the simulation thread\n");
+            should_exit = 1;
+            status = -1;
+        }
+    }
 
-    int fb_width, fb_height;
-    glfwGetFramebufferSize(window, &fb_width, &fb_height);
-    glViewport(0, 0, fb_width, fb_height);
+    if (!should_exit) frame_pacer_init(&frame_pacer, target_fps, "frame_pacer");
+    if (dynamic_min_scale > 0.0f) dynamic_res_init(&dynamic_res, 1000.0 / (target_fps > 0.0 ? target_fps : 60.0), dynamic_min_scale);
     
-    while (!glfwWindowShouldClose(window) && !should_exit) {
+    while (!glfwWindowShouldClose(window) && !should_exit && !latency_done()) {
+        frame_arena_reset();
+        alloc_check_frame();
         clear(0.2f, 0.2f, 0.2f, 1.0f);
 
         int selected = -1;
@@ -272,16 +646,14 @@ int main() {
         int width, height;
         glfwGetWindowSize(window, &width, &height);
 
-        float scale_x = (float)fb_width / width;
-        float scale_y = (float)fb_height / height;
+        float scale_x = width > 0 ? (float)render_target.window_width / width : 1.0f;
+        float scale_y = height > 0 ? (float)render_target.window_height / height : 1.0f;
 
         float mouse_x_fb = mouse_x_pixels * scale_x;
         float mouse_y_fb = mouse_y_pixels * scale_y;
 
-        float mouse_x = (float)(mouse_x_fb / fb_width) * 2.0f - 1.0f;
-        float mouse_y = 1.0f - (float)(mouse_y_fb / fb_height) * 2.0f;
-
-        float speed = 0.02f;
+        float mouse_x, mouse_y;
+        render_target_to_ndc(mouse_x_fb, mouse_y_fb, &mouse_x, &mouse_y);
 
         // Escape key detect
         static int escp_last = 0;
@@ -292,6 +664,21 @@ int main() {
         }
         escp_last = escp_down;
 
+        // Hand this frame's paddle input to the sim thread
+        unsigned buttons = 0;
+        if (playing) {
+            if (key_down(window, GLFW_KEY_W)) buttons |= INPUT_LEFT_UP;
+            if (key_down(window, GLFW_KEY_S)) buttons |= INPUT_LEFT_DOWN;
+            if (key_down(window, GLFW_KEY_UP)) buttons |= INPUT_RIGHT_UP;
+            if (key_down(window, GLFW_KEY_DOWN)) buttons |= INPUT_RIGHT_DOWN;
+            if (key_down(window, GLFW_KEY_Z)) buttons |= INPUT_BOTTOM_LEFT;
+            if (key_down(window, GLFW_KEY_X)) buttons |= INPUT_BOTTOM_RIGHT;
+            if (key_down(window, GLFW_KEY_N)) buttons |= INPUT_TOP_LEFT;
+            if (key_down(window, GLFW_KEY_M)) buttons |= INPUT_TOP_RIGHT;
+        }
+        sim_set_input(&sim, buttons, latency_sampled_event());
+        sim_set_paused(&sim, !playing);
+
         if (!playing) {
 
             /* Check Hover & Clicks */
@@ -341,135 +728,78 @@ int main() {
                 1.0f
             );
 
-            glEnable(GL_TEXTURE_2D);
-            glColor4f(1, 1, 1, 1);
+            // draw_char sets up its own texture state
             const char* play_text = "PLAY";
-            float play_txt_width = strlen(play_text) * button_text_size;
+            float play_txt_width = text_width(play_text, button_text_size);
             float play_txt_x = playButton.x + (playButton.w - play_txt_width) / 2.0f;
             float play_txt_y = playButton.y + (playButton.h + button_text_size) / 2.0f;
             draw_text(play_text, play_txt_x, play_txt_y, button_text_size);
             const char* exit_text = "EXIT";
-            float exit_text_x = exitButton.x + (exitButton.w - strlen(exit_text) * button_text_size) / 2.0f;
+            float exit_text_x = exitButton.x + (exitButton.w - text_width(exit_text, button_text_size)) / 2.0f;
             float exit_text_y = exitButton.y + (exitButton.h + button_text_size) / 2.0f;
             draw_text(exit_text, exit_text_x, exit_text_y, button_text_size);
-            glDisable(GL_TEXTURE_2D);
         } else {
-            /* Gameplay Logic */
-
-            // Move Paddles
-            if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) leftPaddle.y += 0.02f;
-            if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) leftPaddle.y -= 0.02f;
-            if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) rightPaddle.y += 0.02f;
-            if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) rightPaddle.y -= 0.02f;
-            // Clamp Paddles
-            if (leftPaddle.y < -1.0f) leftPaddle.y = -1.0f;
-            if (leftPaddle.y + leftPaddle.h > 1.0f) leftPaddle.y = 1.0f - leftPaddle.h;
-            if (rightPaddle.y < -1.0f) rightPaddle.y = -1.0f;
-            if (rightPaddle.y + rightPaddle.h> 1.0f) rightPaddle.y = 1.0f - rightPaddle.h;
-
-
-            // Move Ball
-            ball.x += ball.vx;
-            ball.y += ball.vy;
-
-
-            // Bounce off Top / Bottom
-            if (ball.y + ball.radius >= 1.0f || ball.y - ball.radius <= -1.0f) ball.vy *= -1;
-
-
-            /* Bounce off Paddles */
-
-            // Left Paddle
-            if (ball.x - ball.radius <= leftPaddle.x + leftPaddle.w &&
-                ball.y >= leftPaddle.y && ball.y <= leftPaddle.y + leftPaddle.h) {
-                    float paddleCenter = leftPaddle.y + leftPaddle.h / 2.0f;
-                    float hitPos = (ball.y - paddleCenter) / (leftPaddle.h / 2.0f); // -1 to 1
-
-                    // Guarantee minimum vertical speed
-                    if (fabs(hitPos) < 0.1f) hitPos = (hitPos < 0 ? -0.1f : 0.1f);
-
-                    // Limit vertical angle so it doesn't go crazzzyyyyy
-                    if (hitPos > 0.9f) hitPos = 0.9f;
-                    if (hitPos < -0.9f) hitPos = -0.9f;
-
-                    // Calculate new velocity with speed constant
-                    ball.vy = hitPos * fabs(ball.vx); // adjust multiplier to control angle
-                    ball.vx = (ball.vx < 0 ? 1 : -1) * sqrt(speed * speed / (1 + hitPos * hitPos));
-
-                    ball.x = leftPaddle.x + leftPaddle.w + ball.radius; // Prevent Sticking
-            }
-            // Right Paddle
-            if (ball.x + ball.radius >= rightPaddle.x &&
-                ball.y >= rightPaddle.y && ball.y <= rightPaddle.y + rightPaddle.h) {
-                    float paddleCenter = rightPaddle.y + rightPaddle.h / 2.0f;
-                    float hitPos = (ball.y - paddleCenter) / (rightPaddle.h / 2.0f); // -1 to 1
-
-                    // Guarantee minimum vertical speed
-                    if (fabs(hitPos) < 0.1f) hitPos = (hitPos < 0 ? -0.1f : 0.1f);
-
-                    // Limit vertical angle so it doesn't go crazzzyyyyy
-                    if (hitPos > 0.9f) hitPos = 0.9f;
-                    if (hitPos < -0.9f) hitPos = -0.9f;
-
-                    // Calculate new velocity with speed constant
-                    ball.vy = hitPos * fabs(ball.vx); // adjust multiplier to control angle
-                    ball.vx = (ball.vx < 0 ? 1 : -1) * sqrt(speed * speed / (1 + hitPos * hitPos));
-
-                    ball.x = rightPaddle.x - ball.radius; // Prevent Sticking
-            }
-
-
-            // Reset if Ball goes too far Left
-            if (ball.x < -1.1f) {
-                ball.x = ball.y = 0.0f;
-                ball.vx = (rand() % 2 ? 0.01f : -0.01f);
-                ball.vy = (rand() % 2 ? 0.015f : -0.015f);
-                right_points++;
-            }
-            // Reset if Ball goes too far right
-            if (ball.x > 1.1f) {
-                ball.x = ball.y = 0.0f;
-                ball.vx = (rand() % 2 ? 0.01f : -0.01f);
-                ball.vy = (rand() % 2 ? 0.015f : -0.015f);
-                left_points++;
-            }
-
-
-            // Draw Paddles
-            draw_rectangle((Rect){leftPaddle.x, leftPaddle.y, leftPaddle.w, leftPaddle.h}, 0.1f, 0.7f, 0.2f, 1.0f);
-            draw_rectangle((Rect){rightPaddle.x, rightPaddle.y, rightPaddle.w, rightPaddle.h}, 0.1f, 0.2f, 0.7f, 1.0f);
-
-            
-            // Draw Ball (Square lol)
-            draw_rectangle((Rect){ball.x - ball.radius, ball.y - ball.radius, ball.radius * 2, ball.radius * 2}, 1.0f, 0.1f, 0.1f, 1.0f);
-
-            /* Scores */
-            glEnable(GL_TEXTURE_2D);
-            glColor4f(1, 1, 1, 1);
+            /* Gameplay */
+            GameState view;
+            sim_view(&sim, &view);
+
+            // Effects; frame time is capped so coming back from the menu doesn't jump them
+            uint64_t now = time_now_ns();
+            if (have_last_view) spawn_effects(&particles, &last_view, &view);
+            particles_update(&particles, fminf((now - last_frame_ns) / 1e9f, 0.1f));
+            last_frame_ns = now;
+            last_view = view;
+            have_last_view = 1;
+
+            // Paddles, ball and scores; the offline renderer draws the same scene
+            Scene scene;
+            scene_game(&scene, &view);
+            draw_scene(&scene);
+            draw_particles(&particles);
+
+            latency_mark_submit(view.input_event);
+        }
 
-            // Left
-            char left_score[16];
-            sprintf(left_score, "%d", left_points);
-            float left_score_width = strlen(left_score) * button_text_size;
-            float left_score_x = -0.5f - left_score_width / 2.0f;
-            float left_score_y = 0.8f;
-            draw_text(left_score, left_score_x, left_score_y, button_text_size);
+        left_down_last_frame = left_down;        
 
-            // Right
-            char right_score[16];
-            sprintf(right_score, "%d", right_points);
-            float right_score_width = strlen(right_score) * button_text_size;
-            float right_score_x = 0.5f - right_score_width / 2.0f;
-            float right_score_y = 0.8f;
-            draw_text(right_score, right_score_x, right_score_y, button_text_size);
+        swap_and_poll(window, &frame_pacer);
 
-            glDisable(GL_TEXTURE_2D);
+        // Startup is over once the first menu or match frame is on screen
+        if (startup_enabled() && !startup_reported) {
+            startup_mark("first interactive frame");
+            startup_report(stdout);
+            startup_reported = 1;
+            if (startup_exit) should_exit = 1;
         }
+    }
 
-        left_down_last_frame = left_down;        
-
-        swap_and_poll(window);
+    alloc_check_end();
+    if (alloc_check_enabled()) {
+        alloc_check_report(stdout);
+        frame_arena_report(stdout);
+    }
+    frame_pacer_summary(&frame_pacer);
+    dynamic_res_summary(&dynamic_res);
+    dynamic_res_shutdown(&dynamic_res);
+    if (sim_running) {
+        sim_stop(&sim);
+        if (record_path && !replay_save(&replay, record_path)) fprintf(stderr, "Could not save replay: %s\n", record_path);
+    }
+    replay_free(&replay);
+    court_free(&court);
+    frame_arena_shutdown();
+    glyph_cache_shutdown();
+    instancing_shutdown();
+    stream_shutdown();
+    capture_stop();
+    render_target_shutdown();
+    asset_pack_close(&pack);
+
+    if (latency_enabled()) {
+        latency_report(stdout);
+        latency_stop();
     }
 
     window_exit(window);
+    return status;
 }
@@ -0,0 +1,148 @@
+#define _GNU_SOURCE
+#include "alloc_check.h"
+
+#include <stddef.h>
+
+#define MAX_TRACES  16    // Printed with a backtrace; the rest are only counted
+#define TRACE_DEPTH 24
+
+static struct {
+    int enabled;
+    int warmup;
+    unsigned long long frames;          // Loop iterations since enabling
+    unsigned long long caught;          // Heap calls made by the program in checked frames
+    unsigned long long in_libraries;    // Made inside the GL driver, GLFW and so on; not ours to fix
+    unsigned long long frees;           // Not attributed: libraries tail-call free, so it looks like ours
+    unsigned long long dirty_frames;    // Checked frames with at least one caught call
+    unsigned long long last_dirty;
+    int traces;
+    const void* program_base;
+    const void* libc_base;
+} check;
+
+// Only the thread running the loop arms itself; the sim and capture threads are never checked
+static _Thread_local int armed;
+static _Thread_local int paused;
+static _Thread_local int in_hook;       // backtrace() and dladdr() must not land back here
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <unistd.h>
+
+#define ALLOC_CHECK_AVAILABLE 1
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+extern void __libc_free(void* pointer);
+
+// 1 if the first caller outside the C library is the program itself, 0 for a library (Backtrace, Depth)
+static int called_by_program(void** trace, int depth) {
+    for (int i = 2; i < depth; i++) {    // 0 is caught, 1 the malloc replacement
+        Dl_info info;
+        if (!dladdr(trace[i], &info)) continue;
+        if (info.dli_fbase == check.program_base) return 1;
+        if (info.dli_fbase != check.libc_base) return 0;
+    }
+    return 0;
+}
+
+// Count a heap call and print where it came from, straight to fd 2 rather than through stdio (Function name, Bytes)
+__attribute__((noinline)) static void caught(const char* what, size_t bytes) {
+    if (!armed || paused || in_hook) return;
+    in_hook = 1;
+    void* trace[TRACE_DEPTH];
+    int depth = backtrace(trace, TRACE_DEPTH);
+    if (!called_by_program(trace, depth)) {
+        check.in_libraries++;
+        in_hook = 0;
+        return;
+    }
+
+    check.caught++;
+    if (check.last_dirty != check.frames) {
+        check.last_dirty = check.frames;
+        check.dirty_frames++;
+    }
+    if (check.traces < MAX_TRACES) {
+        check.traces++;
+        char line[96];
+        int length = snprintf(line, sizeof(line), "alloc_check: checked frame %llu: %s(%zu)\n", check.frames - check.warmup, what, bytes);
+        (void)!write(2, line, length);
+        backtrace_symbols_fd(trace + 1, depth - 1, 2);
+    }
+    in_hook = 0;
+}
+
+void* malloc(size_t size) {
+    if (check.enabled) caught("malloc", size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (check.enabled) caught("calloc", count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    if (check.enabled) caught("realloc", size);
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    if (check.enabled && pointer && armed && !paused) check.frees++;
+    __libc_free(pointer);
+}
+#else
+#define ALLOC_CHECK_AVAILABLE 0
+#endif
+
+int alloc_check_available(void) {
+    return ALLOC_CHECK_AVAILABLE;
+}
+
+void alloc_check_enable(int warmup_frames) {
+#if ALLOC_CHECK_AVAILABLE
+    Dl_info info;
+    if (dladdr((void*)alloc_check_enable, &info)) check.program_base = info.dli_fbase;
+    if (dladdr((void*)__libc_malloc, &info)) check.libc_base = info.dli_fbase;
+
+    // Load the unwinder now rather than inside the first caught call
+    void* trace[2];
+    backtrace(trace, 2);
+
+    check.warmup = warmup_frames > 0 ? warmup_frames : 0;
+    check.enabled = 1;
+#endif
+}
+
+int alloc_check_enabled(void) {
+    return check.enabled;
+}
+
+void alloc_check_frame(void) {
+    if (!check.enabled) return;
+    check.frames++;
+    armed = check.frames > (unsigned long long)check.warmup;
+    paused = 0;
+}
+
+void alloc_check_pause(int pause) {
+    paused = pause;
+}
+
+void alloc_check_end(void) {
+    armed = 0;
+}
+
+unsigned long long alloc_check_report(FILE* out) {
+    armed = 0;
+    if (!check.enabled) return 0;
+    unsigned long long checked = check.frames > (unsigned long long)check.warmup ? check.frames - check.warmup : 0;
+    fprintf(out, "alloc_check: %llu heap calls from the program in %llu of %llu checked frames (after %d warm-up frames)%s\n",
+        check.caught, check.dirty_frames, checked, check.warmup, check.caught ? "" : ", steady state is allocation-free");
+    if (check.in_libraries) fprintf(out, "alloc_check: %llu more made inside libraries (GL driver, GLFW), not counted\n", check.in_libraries);
+    if (check.frees) fprintf(out, "alloc_check: %llu frees in checked frames, from anywhere\n", check.frees);
+    return check.caught;
+}
@@ -0,0 +1,70 @@
+#include "asset_pack.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Whether [offset, offset + size) is inside the mapping; compared so that neither side can wrap
+static int in_pack(const AssetPack* pack, uint64_t offset, uint64_t size) {
+    return offset <= pack->size && size <= pack->size - offset;
+}
+
+int asset_pack_open(AssetPack* pack, const char* path) {
+    memset(pack, 0, sizeof(*pack));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(AssetPackHeader)) {
+        close(fd);
+        return 0;
+    }
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return 0;
+
+    pack->base = base;
+    pack->size = st.st_size;
+    pack->header = base;
+
+    const AssetPackHeader* header = pack->header;
+    uint64_t index_size = (uint64_t)header->entry_count * sizeof(AssetEntry);
+    if (header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION ||
+        header->file_size != pack->size || !in_pack(pack, header->index_offset, index_size) ||
+        header->index_offset % _Alignof(AssetEntry) != 0) {
+        fprintf(stderr, "Bad asset pack: %s\n", path);
+        asset_pack_close(pack);
+        return 0;
+    }
+    pack->entries = (const AssetEntry*)(pack->base + header->index_offset);
+
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        if (!in_pack(pack, pack->entries[i].offset, pack->entries[i].size)) {
+            fprintf(stderr, "Bad asset pack entry %.*s in %s\n", ASSET_NAME_MAX, pack->entries[i].name, path);
+            asset_pack_close(pack);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void asset_pack_close(AssetPack* pack) {
+    if (pack->base) munmap((void*)pack->base, pack->size);
+    memset(pack, 0, sizeof(*pack));
+}
+
+const AssetEntry* asset_pack_find(const AssetPack* pack, const char* name, int type) {
+    if (!pack->base) return NULL;
+    for (uint32_t i = 0; i < pack->header->entry_count; i++) {
+        const AssetEntry* entry = &pack->entries[i];
+        if (strncmp(entry->name, name, ASSET_NAME_MAX) == 0 && (type < 0 || entry->type == (uint32_t)type)) return entry;
+    }
+    return NULL;
+}
+
+const void* asset_pack_data(const AssetPack* pack, const AssetEntry* entry) {
+    return pack->base + entry->offset;
+}
@@ -0,0 +1,263 @@
+#include "capture.h"
+#include "gl_ext.h"
+#include "render_target.h"
+#include "y4m.h"
+
+#include <GLFW/glfw3.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPTURE_PBOS   3   // Readbacks in flight
+#define CAPTURE_FRAMES 8   // Copied frames waiting for the writer
+
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED     0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED  0x911C
+#endif
+
+static struct {
+    int active;
+    int y4m;
+    FILE* out;
+    const char* path;
+    int width, height;
+    size_t frame_bytes;
+    unsigned long long written, dropped;
+
+    /* Render thread only */
+    int async;                    // 1 = PBO ring, 0 = plain glReadPixels
+    GLuint pbos[CAPTURE_PBOS];
+    GLExtSync fences[CAPTURE_PBOS];
+    int oldest, in_flight;
+
+    /* Shared with the writer, under lock */
+    unsigned char* frames[CAPTURE_FRAMES];
+    unsigned char* planes;        // Writer's y4m conversion buffer
+    int free_ids[CAPTURE_FRAMES], free_count;
+    int full_ids[CAPTURE_FRAMES], full_first, full_count;
+    int running;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_t writer;
+} cap;
+
+// Raw frames are written top-down; GL hands them over bottom-up
+static void write_rgba(const unsigned char* rgba) {
+    size_t stride = (size_t)cap.width * 4;
+    for (int y = cap.height - 1; y >= 0; y--) fwrite(rgba + y * stride, 1, stride, cap.out);
+}
+
+// Writer thread: drains the full queue until capture_stop and the queue is empty
+static void* capture_writer(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&cap.lock);
+    for (;;) {
+        while (cap.full_count == 0 && cap.running) pthread_cond_wait(&cap.ready, &cap.lock);
+        if (cap.full_count == 0) break;
+
+        int id = cap.full_ids[cap.full_first];
+        cap.full_first = (cap.full_first + 1) % CAPTURE_FRAMES;
+        cap.full_count--;
+        pthread_mutex_unlock(&cap.lock);
+
+        if (cap.y4m) {
+            y4m_convert(cap.frames[id], cap.width, cap.height, 1, cap.planes);
+            y4m_write_frame(cap.out, cap.planes, cap.width, cap.height);
+        } else {
+            write_rgba(cap.frames[id]);
+        }
+
+        pthread_mutex_lock(&cap.lock);
+        cap.free_ids[cap.free_count++] = id;
+        cap.written++;
+    }
+    pthread_mutex_unlock(&cap.lock);
+    return NULL;
+}
+
+// Take a free frame buffer without waiting; -1 when the writer is behind
+static int take_frame(void) {
+    int id = -1;
+    pthread_mutex_lock(&cap.lock);
+    if (cap.free_count > 0) id = cap.free_ids[--cap.free_count];
+    else cap.dropped++;
+    pthread_mutex_unlock(&cap.lock);
+    return id;
+}
+
+static void queue_frame(int id) {
+    pthread_mutex_lock(&cap.lock);
+    cap.full_ids[(cap.full_first + cap.full_count) % CAPTURE_FRAMES] = id;
+    cap.full_count++;
+    pthread_cond_signal(&cap.ready);
+    pthread_mutex_unlock(&cap.lock);
+}
+
+// Free the frame buffers and PBOs and close the file; capture_start's failure path and capture_stop share it
+static void release_buffers(void) {
+    if (cap.async) {
+        gl_ext.bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+        gl_ext.delete_buffers(CAPTURE_PBOS, cap.pbos);
+    }
+    fclose(cap.out);
+    for (int i = 0; i < CAPTURE_FRAMES; i++) free(cap.frames[i]);
+    free(cap.planes);
+}
+
+int capture_start(const char* path, double fps) {
+    memset(&cap, 0, sizeof(cap));
+    if (!render_target.offscreen) {
+        fprintf(stderr, "capture: needs the offscreen target; not capturing\n");
+        return 0;
+    }
+    cap.out = fopen(path, "wb");
+    if (!cap.out) {
+        fprintf(stderr, "capture: could not open %s\n", path);
+        return 0;
+    }
+
+    const char* ext = strrchr(path, '.');
+    cap.y4m = ext && strcmp(ext, ".y4m") == 0;
+    cap.path = path;
+    cap.width = render_target.width;
+    cap.height = render_target.height;
+    cap.frame_bytes = (size_t)cap.width * cap.height * 4;
+
+    if (cap.y4m) y4m_write_header(cap.out, cap.width, cap.height, fps);
+
+    int allocated = 1;
+    for (int i = 0; i < CAPTURE_FRAMES; i++) {
+        cap.frames[i] = malloc(cap.frame_bytes);
+        cap.free_ids[cap.free_count++] = i;
+        if (!cap.frames[i]) allocated = 0;
+    }
+    if (cap.y4m) {
+        cap.planes = malloc(y4m_frame_size(cap.width, cap.height));
+        if (!cap.planes) allocated = 0;
+    }
+    if (!allocated) {
+        fprintf(stderr, "capture: out of memory for %dx%d frames; not capturing\n", cap.width, cap.height);
+        release_buffers();
+        remove(path);
+        return 0;
+    }
+
+    cap.async = gl_ext.has_pbo;
+    if (cap.async) {
+        gl_ext.gen_buffers(CAPTURE_PBOS, cap.pbos);
+        for (int i = 0; i < CAPTURE_PBOS; i++) {
+            gl_ext.bind_buffer(GL_PIXEL_PACK_BUFFER, cap.pbos[i]);
+            gl_ext.buffer_data(GL_PIXEL_PACK_BUFFER, cap.frame_bytes, NULL, GL_STREAM_READ);
+        }
+        gl_ext.bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+    } else {
+        fprintf(stderr, "capture: no pixel buffer objects; readback will stall every frame\n");
+    }
+
+    pthread_mutex_init(&cap.lock, NULL);
+    pthread_cond_init(&cap.ready, NULL);
+    cap.running = 1;
+    if (pthread_create(&cap.writer, NULL, capture_writer, NULL) != 0) {
+        fprintf(stderr, "capture: could not start the writer thread; not capturing\n");
+        pthread_mutex_destroy(&cap.lock);
+        pthread_cond_destroy(&cap.ready);
+        release_buffers();
+        remove(path);
+        return 0;
+    }
+    cap.active = 1;
+    return 1;
+}
+
+int capture_active(void) {
+    return cap.active;
+}
+
+// The oldest readback has landed (without fences: it is a full ring old, so assume so)
+static int oldest_ready(void) {
+    if (cap.in_flight == 0) return 0;
+    GLExtSync fence = cap.fences[cap.oldest];
+    if (!fence) return cap.in_flight == CAPTURE_PBOS;
+    GLenum status = gl_ext.client_wait_sync(fence, 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+// Copy the oldest readback into the writer's queue (or drop it) and free its PBO
+static void retire_oldest(void) {
+    int slot = cap.oldest;
+    if (cap.fences[slot]) {
+        gl_ext.delete_sync(cap.fences[slot]);
+        cap.fences[slot] = NULL;
+    }
+
+    int id = take_frame();
+    if (id >= 0) {
+        gl_ext.bind_buffer(GL_PIXEL_PACK_BUFFER, cap.pbos[slot]);
+        const void* pixels = gl_ext.map_buffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (pixels) {
+            memcpy(cap.frames[id], pixels, cap.frame_bytes);
+            gl_ext.unmap_buffer(GL_PIXEL_PACK_BUFFER);
+            queue_frame(id);
+        } else {
+            pthread_mutex_lock(&cap.lock);
+            cap.free_ids[cap.free_count++] = id;
+            cap.dropped++;
+            pthread_mutex_unlock(&cap.lock);
+        }
+    }
+    cap.oldest = (cap.oldest + 1) % CAPTURE_PBOS;
+    cap.in_flight--;
+}
+
+void capture_frame(void) {
+    if (!cap.active) return;
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    if (!cap.async) {
+        int id = take_frame();
+        if (id < 0) return;
+        glReadPixels(0, 0, cap.width, cap.height, GL_RGBA, GL_UNSIGNED_BYTE, cap.frames[id]);
+        queue_frame(id);
+        return;
+    }
+
+    while (oldest_ready()) retire_oldest();
+
+    // Every PBO still in flight: the GPU is behind, skip this frame rather than wait
+    if (cap.in_flight == CAPTURE_PBOS) {
+        pthread_mutex_lock(&cap.lock);
+        cap.dropped++;
+        pthread_mutex_unlock(&cap.lock);
+    } else {
+        int slot = (cap.oldest + cap.in_flight) % CAPTURE_PBOS;
+        gl_ext.bind_buffer(GL_PIXEL_PACK_BUFFER, cap.pbos[slot]);
+        glReadPixels(0, 0, cap.width, cap.height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        if (gl_ext.has_sync) cap.fences[slot] = gl_ext.fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        cap.in_flight++;
+    }
+    gl_ext.bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void capture_stop(void) {
+    if (!cap.active) return;
+
+    /* Mapping waits for whatever is still in flight; fine at shutdown */
+    while (cap.in_flight > 0) retire_oldest();
+
+    pthread_mutex_lock(&cap.lock);
+    cap.running = 0;
+    pthread_cond_signal(&cap.ready);
+    pthread_mutex_unlock(&cap.lock);
+    pthread_join(cap.writer, NULL);
+
+    release_buffers();
+    pthread_mutex_destroy(&cap.lock);
+    pthread_cond_destroy(&cap.ready);
+    cap.active = 0;
+
+    fprintf(stderr, "capture: %llu frames written, %llu dropped -> %s\n", cap.written, cap.dropped, cap.path);
+}
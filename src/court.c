@@ -0,0 +1,205 @@
+#include "court.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CELL_SIZE (2.0f / COURT_GRID)
+
+void court_init(Court* court) {
+    memset(court, 0, sizeof(*court));
+}
+
+void court_free(Court* court) {
+    free(court->rects);
+    free(court->circles);
+    free(court->cell_items);
+    memset(court, 0, sizeof(*court));
+}
+
+void court_add_rect(Court* court, float x, float y, float w, float h) {
+    if (court->rect_count == court->capacity_rects) {
+        int capacity = court->capacity_rects ? court->capacity_rects * 2 : 16;
+        CourtRect* rects = realloc(court->rects, capacity * sizeof(CourtRect));
+        if (!rects) return;
+        court->rects = rects;
+        court->capacity_rects = capacity;
+    }
+    court->rects[court->rect_count++] = (CourtRect){ x, y, x + w, y + h };
+}
+
+void court_add_circle(Court* court, float x, float y, float r) {
+    if (court->circle_count == court->capacity_circles) {
+        int capacity = court->capacity_circles ? court->capacity_circles * 2 : 16;
+        CourtCircle* circles = realloc(court->circles, capacity * sizeof(CourtCircle));
+        if (!circles) return;
+        court->circles = circles;
+        court->capacity_circles = capacity;
+    }
+    court->circles[court->circle_count++] = (CourtCircle){ x, y, r };
+}
+
+// Cell column / row of a coordinate, clamped onto the grid
+static int cell_coord(float v) {
+    int c = (int)floorf((v + 1.0f) / CELL_SIZE);
+    return c < 0 ? 0 : c >= COURT_GRID ? COURT_GRID - 1 : c;
+}
+
+// Bounds of obstacle entry i (Court, Entry, Output min / max)
+static void item_bounds(const Court* court, int i, float* x0, float* y0, float* x1, float* y1) {
+    if (i < court->rect_count) {
+        const CourtRect* rect = &court->rects[i];
+        *x0 = rect->x0; *y0 = rect->y0; *x1 = rect->x1; *y1 = rect->y1;
+    } else {
+        const CourtCircle* circle = &court->circles[i - court->rect_count];
+        *x0 = circle->x - circle->r; *y0 = circle->y - circle->r;
+        *x1 = circle->x + circle->r; *y1 = circle->y + circle->r;
+    }
+}
+
+int court_build(Court* court) {
+    /* Two passes over the cells each obstacle covers: count, then fill (counting sort) */
+    int items = court->rect_count + court->circle_count;
+    int counts[COURT_GRID * COURT_GRID] = { 0 };
+    int total = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < items; i++) {
+            float x0, y0, x1, y1;
+            item_bounds(court, i, &x0, &y0, &x1, &y1);
+            for (int cy = cell_coord(y0); cy <= cell_coord(y1); cy++) {
+                for (int cx = cell_coord(x0); cx <= cell_coord(x1); cx++) {
+                    int cell = cy * COURT_GRID + cx;
+                    if (pass == 0) {
+                        counts[cell]++;
+                        total++;
+                    } else {
+                        court->cell_items[court->cell_start[cell] + counts[cell]++] = i;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            free(court->cell_items);
+            court->cell_items = malloc((total ? total : 1) * sizeof(int));
+            if (!court->cell_items) return 0;
+            court->cell_start[0] = 0;
+            for (int c = 0; c < COURT_GRID * COURT_GRID; c++) court->cell_start[c + 1] = court->cell_start[c] + counts[c];
+            memset(counts, 0, sizeof(counts));
+        }
+    }
+    return 1;
+}
+
+int court_load(Court* court, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Could not open court: %s\n", path);
+        return 0;
+    }
+    court_init(court);
+
+    char line[256];
+    int number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char kind[16];
+        float a, b, c, d;
+        int fields = sscanf(line, "%15s %f %f %f %f", kind, &a, &b, &c, &d);
+        if (fields <= 0) continue;
+        if (strcmp(kind, "rect") == 0 && fields == 5 && c > 0.0f && d > 0.0f) {
+            court_add_rect(court, a, b, c, d);
+        } else if (strcmp(kind, "circle") == 0 && fields == 4 && c > 0.0f) {
+            court_add_circle(court, a, b, c);
+        } else {
+            fprintf(stderr, "%s:%d: expected \"rect x y w h\" or \"circle x y r\"\n", path, number);
+            fclose(file);
+            court_free(court);
+            return 0;
+        }
+    }
+    fclose(file);
+    return court_build(court);
+}
+
+// Ray against a rectangle grown by the radius (slab test); starting inside never hits, so a ball can get out
+static int sweep_rect(const CourtRect* rect, float x, float y, float dx, float dy, float radius, CourtHit* hit) {
+    float lo[2] = { rect->x0 - radius, rect->y0 - radius };
+    float hi[2] = { rect->x1 + radius, rect->y1 + radius };
+    float p[2] = { x, y }, d[2] = { dx, dy };
+    float enter = -1.0f, leave = 2.0f;
+    int axis = -1;
+
+    for (int k = 0; k < 2; k++) {
+        if (d[k] == 0.0f) {
+            if (p[k] <= lo[k] || p[k] >= hi[k]) return 0;
+            continue;
+        }
+        float t0 = (lo[k] - p[k]) / d[k], t1 = (hi[k] - p[k]) / d[k];
+        if (t0 > t1) {
+            float swap = t0; t0 = t1; t1 = swap;
+        }
+        if (t0 > enter) {
+            enter = t0;
+            axis = k;
+        }
+        if (t1 < leave) leave = t1;
+    }
+    if (axis < 0 || enter < 0.0f || enter > 1.0f || enter > leave) return 0;
+
+    hit->t = enter;
+    hit->nx = axis == 0 ? (dx > 0.0f ? -1.0f : 1.0f) : 0.0f;
+    hit->ny = axis == 1 ? (dy > 0.0f ? -1.0f : 1.0f) : 0.0f;
+    return 1;
+}
+
+// Ray against a circle grown by the radius
+static int sweep_circle(const CourtCircle* circle, float x, float y, float dx, float dy, float radius, CourtHit* hit) {
+    float reach = circle->r + radius;
+    float mx = x - circle->x, my = y - circle->y;
+    float b = mx * dx + my * dy;
+    float c = mx * mx + my * my - reach * reach;
+    if (c <= 0.0f || b >= 0.0f) return 0;   // Inside already, or moving away
+
+    float a = dx * dx + dy * dy;
+    float disc = b * b - a * c;
+    if (disc < 0.0f) return 0;
+    float t = (-b - sqrtf(disc)) / a;
+    if (t < 0.0f || t > 1.0f) return 0;
+
+    hit->t = t;
+    hit->nx = (mx + dx * t) / reach;
+    hit->ny = (my + dy * t) / reach;
+    return 1;
+}
+
+int court_sweep(const Court* court, float x, float y, float dx, float dy, float radius, CourtHit* hit) {
+    if (!court->cell_items) return 0;
+
+    /* Cells under the swept box; an obstacle in several of them is just tested again */
+    float x0 = fminf(x, x + dx) - radius, x1 = fmaxf(x, x + dx) + radius;
+    float y0 = fminf(y, y + dy) - radius, y1 = fmaxf(y, y + dy) + radius;
+    int found = 0;
+    hit->t = 2.0f;
+
+    for (int cy = cell_coord(y0); cy <= cell_coord(y1); cy++) {
+        for (int cx = cell_coord(x0); cx <= cell_coord(x1); cx++) {
+            int cell = cy * COURT_GRID + cx;
+            for (int k = court->cell_start[cell]; k < court->cell_start[cell + 1]; k++) {
+                int i = court->cell_items[k];
+                CourtHit candidate;
+                int hits = i < court->rect_count
+                    ? sweep_rect(&court->rects[i], x, y, dx, dy, radius, &candidate)
+                    : sweep_circle(&court->circles[i - court->rect_count], x, y, dx, dy, radius, &candidate);
+                if (hits && candidate.t < hit->t) {
+                    *hit = candidate;
+                    found = 1;
+                }
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,97 @@
+#include "decode_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGNMENT 16
+
+static _Thread_local DecodeArena* current;   // Per thread, so batch decode workers stay on the heap
+
+int decode_arena_init(DecodeArena* arena, size_t bytes) {
+    memset(arena, 0, sizeof(*arena));
+    arena->base = malloc(bytes);
+    if (!arena->base) return 0;
+    arena->size = arena->newest = bytes;
+    return 1;
+}
+
+void decode_arena_release(DecodeArena* arena) {
+    if (current == arena) current = NULL;
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = arena->used = arena->newest = 0;
+}
+
+void decode_arena_begin(DecodeArena* arena) {
+    arena->used = 0;
+    arena->newest = arena->size;
+    arena->scope_peak = 0;
+    current = arena;
+}
+
+void decode_arena_end(DecodeArena* arena) {
+    if (current == arena) current = NULL;
+    arena->used = 0;
+    arena->newest = arena->size;
+}
+
+// Whether a block came from the current arena (Block)
+static int owned(const void* block) {
+    return current && block && (const unsigned char*)block >= current->base &&
+        (const unsigned char*)block < current->base + current->size;
+}
+
+void* decode_malloc(size_t bytes) {
+    if (!current) return malloc(bytes);
+
+    size_t start = (current->used + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    if (start > current->size || bytes > current->size - start) {
+        current->failed++;
+        return NULL;
+    }
+    current->used = start + bytes;
+    current->newest = start;
+    current->allocations++;
+    if (current->used > current->scope_peak) current->scope_peak = current->used;
+    if (current->used > current->high_water) current->high_water = current->used;
+    return current->base + start;
+}
+
+void* decode_realloc(void* block, size_t old_bytes, size_t bytes) {
+    if (!block) return decode_malloc(bytes);
+    if (!owned(block)) return realloc(block, bytes);
+
+    /* The newest block just moves the end; anything older is copied to a new one */
+    size_t offset = (unsigned char*)block - current->base;
+    if (offset == current->newest) {
+        if (bytes > current->size - offset) {
+            current->failed++;
+            return NULL;
+        }
+        current->used = offset + bytes;
+        if (current->used > current->scope_peak) current->scope_peak = current->used;
+        if (current->used > current->high_water) current->high_water = current->used;
+        return block;
+    }
+    void* moved = decode_malloc(bytes);
+    if (moved) memcpy(moved, block, old_bytes < bytes ? old_bytes : bytes);
+    return moved;
+}
+
+void decode_free(void* block) {
+    if (!owned(block)) {
+        free(block);
+        return;
+    }
+    // Only the newest block gives its space back early; the rest waits for decode_arena_end
+    size_t offset = (unsigned char*)block - current->base;
+    if (offset == current->newest) {
+        current->used = offset;
+        current->newest = current->size;
+    }
+}
+
+void decode_arena_report(const DecodeArena* arena, const char* label, FILE* out) {
+    fprintf(out, "%s: decode arena peak %zu bytes (high-water %zu) of %zu, %u blocks, %u over the cap\n",
+        label, arena->scope_peak, arena->high_water, arena->size, arena->allocations, arena->failed);
+}
@@ -0,0 +1,124 @@
+#include "dynamic_res.h"
+#include "gl_ext.h"
+#include "render_target.h"
+#include "utils.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define SHRINK_AFTER   3      // Samples over budget before shrinking
+#define GROW_AFTER     60     // Samples under GROW_BELOW before growing (about a second)
+#define GROW_BELOW     0.7    // Fraction of the budget that counts as headroom
+#define AIM            0.85   // Fraction of the budget a change aims for
+#define GROW_STEP      1.1f   // Largest single increase
+#define COOLDOWN       8      // Samples skipped after a change; covers the query delay
+
+void dynamic_res_init(DynamicRes* dr, double budget_ms, float min_scale) {
+    dr->enabled = render_target.offscreen;
+    dr->budget_ns = (uint64_t)(budget_ms * 1e6);
+    dr->min_scale = clamp(min_scale, 0.1f, 1.0f);
+    dr->scale = 1.0f;
+    dr->cost_ns = 0.0;
+    dr->over = dr->under = 0;
+    dr->cooldown = 0;
+    dr->changes = 0;
+    dr->begin_ns = 0;
+    dr->head = 0;
+    dr->timing = 0;
+    dr->gpu = gl_ext.has_timer_query;
+
+    if (!dr->enabled) {
+        fprintf(stderr, "dynamic_res: needs the offscreen target; staying at full resolution\n");
+        return;
+    }
+    if (dr->gpu) gl_ext.gen_queries(DYNAMIC_RES_QUERIES, dr->queries);
+    for (int i = 0; i < DYNAMIC_RES_QUERIES; i++) dr->pending[i] = 0;
+}
+
+void dynamic_res_shutdown(DynamicRes* dr) {
+    if (dr->enabled && dr->gpu) gl_ext.delete_queries(DYNAMIC_RES_QUERIES, dr->queries);
+    dr->enabled = 0;
+}
+
+// Feed one frame cost to the controller
+static void sample(DynamicRes* dr, uint64_t cost_ns) {
+    dr->cost_ns = dr->cost_ns > 0.0 ? dr->cost_ns + (cost_ns - dr->cost_ns) * 0.2 : (double)cost_ns;
+    if (dr->cooldown > 0) {
+        dr->cooldown--;
+        return;
+    }
+
+    dr->over = dr->cost_ns > dr->budget_ns ? dr->over + 1 : 0;
+    dr->under = dr->cost_ns < dr->budget_ns * GROW_BELOW ? dr->under + 1 : 0;
+
+    float scale = dr->scale;
+    // Cost goes with the pixel count, i.e. with scale squared
+    float ideal = dr->scale * (float)sqrt(dr->budget_ns * AIM / dr->cost_ns);
+    if (dr->over >= SHRINK_AFTER) {
+        scale = fminf(ideal, dr->scale * 0.95f);
+    } else if (dr->under >= GROW_AFTER) {
+        scale = fminf(ideal, dr->scale * GROW_STEP);
+    }
+    scale = clamp(scale, dr->min_scale, 1.0f);
+    if (fabsf(scale - dr->scale) < 0.01f) return;
+
+    // Predict the new cost so the average doesn't have to relearn it from scratch
+    dr->cost_ns *= (scale * scale) / (dr->scale * dr->scale);
+    dr->scale = scale;
+    dr->over = dr->under = 0;
+    dr->cooldown = COOLDOWN;
+    dr->changes++;
+    render_target_set_scale(scale);
+    fprintf(stderr, "dynamic_res: %.2f ms against a %.2f ms budget, scale %.2f (%dx%d)\n",
+        cost_ns / 1e6, dr->budget_ns / 1e6, scale, render_target.scaled_width, render_target.scaled_height);
+}
+
+// Collect every finished query, oldest first, without waiting on the GPU
+static void collect(DynamicRes* dr) {
+    for (int n = 0; n < DYNAMIC_RES_QUERIES; n++) {
+        int slot = (dr->head + n) % DYNAMIC_RES_QUERIES;
+        if (!dr->pending[slot]) continue;
+
+        GLint available = 0;
+        gl_ext.get_query_objectiv(dr->queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        unsigned long long elapsed = 0;
+        gl_ext.get_query_objectui64v(dr->queries[slot], GL_QUERY_RESULT, &elapsed);
+        dr->pending[slot] = 0;
+        sample(dr, elapsed);
+    }
+}
+
+void dynamic_res_frame_begin(DynamicRes* dr) {
+    if (!dr->enabled) return;
+    dr->begin_ns = time_now_ns();
+    if (!dr->gpu) return;
+
+    // Every slot still in flight: skip timing this frame rather than wait
+    dr->timing = !dr->pending[dr->head];
+    if (dr->timing) gl_ext.begin_query(GL_TIME_ELAPSED, dr->queries[dr->head]);
+}
+
+void dynamic_res_frame_end(DynamicRes* dr) {
+    if (!dr->enabled) return;
+
+    if (dr->gpu) {
+        if (dr->timing) {
+            gl_ext.end_query(GL_TIME_ELAPSED);
+            dr->pending[dr->head] = 1;
+            dr->head = (dr->head + 1) % DYNAMIC_RES_QUERIES;
+            dr->timing = 0;
+        }
+        collect(dr);
+    } else if (dr->begin_ns) {
+        glFinish();
+        sample(dr, time_now_ns() - dr->begin_ns);
+    }
+}
+
+void dynamic_res_summary(const DynamicRes* dr) {
+    if (!dr->enabled) return;
+    fprintf(stderr, "dynamic_res: %u changes, %s timing, final scale %.2f (%dx%d)\n", dr->changes,
+        dr->gpu ? "GPU" : "CPU", dr->scale, render_target.scaled_width, render_target.scaled_height);
+}
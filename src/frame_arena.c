@@ -0,0 +1,70 @@
+#include "frame_arena.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+#define ALIGNMENT 16
+
+static struct {
+    unsigned char* base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+    unsigned long long failed;
+    unsigned long long frames;
+} arena;
+
+int frame_arena_init(size_t bytes) {
+    arena.base = malloc(bytes);
+    arena.size = arena.base ? bytes : 0;
+    arena.used = arena.high_water = 0;
+    arena.failed = arena.frames = 0;
+    return arena.base != NULL;
+}
+
+void frame_arena_shutdown(void) {
+    free(arena.base);
+    arena.base = NULL;
+    arena.size = arena.used = 0;
+}
+
+void frame_arena_reset(void) {
+    if (arena.used > arena.high_water) arena.high_water = arena.used;
+    arena.used = 0;
+    arena.frames++;
+}
+
+void* frame_alloc(size_t bytes) {
+    size_t start = (arena.used + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    if (!arena.base || start > arena.size || bytes > arena.size - start) {
+        arena.failed++;
+        return NULL;
+    }
+    arena.used = start + bytes;
+    return arena.base + start;
+}
+
+char* frame_printf(const char* format, ...) {
+    static char empty[1];
+
+    /* Format straight into the free space, then keep only what was written */
+    size_t start = (arena.used + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    size_t room = arena.base && start < arena.size ? arena.size - start : 0;
+    va_list args;
+    va_start(args, format);
+    int length = room ? vsnprintf((char*)arena.base + start, room, format, args) : -1;
+    va_end(args);
+
+    if (length < 0 || (size_t)length >= room) {
+        arena.failed++;
+        return empty;
+    }
+    arena.used = start + length + 1;
+    return (char*)arena.base + start;
+}
+
+void frame_arena_report(FILE* out) {
+    size_t peak = arena.used > arena.high_water ? arena.used : arena.high_water;
+    fprintf(out, "frame_arena: %zu of %zu bytes at peak over %llu frames, %llu requests didn't fit\n",
+        peak, arena.size, arena.frames, arena.failed);
+}
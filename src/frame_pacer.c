@@ -0,0 +1,84 @@
+#include "frame_pacer.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+#define LATCH_MARGIN_NS 1000000ull  // Slack kept between predicted work end and the deadline
+#define WORK_DECAY_NS   20000ull    // How fast the work estimate relaxes after a spike, per frame
+
+// Sleep until an absolute CLOCK_MONOTONIC time, spinning for the last spin_ns
+static void sleep_until(uint64_t wake_ns, uint64_t spin_ns) {
+    uint64_t now = time_now_ns();
+    if (wake_ns > now + spin_ns) {
+        uint64_t sleep_to = wake_ns - spin_ns;
+#ifdef __APPLE__
+        // No clock_nanosleep on macOS; a relative sleep is close enough before the spin
+        uint64_t rel = sleep_to - now;
+        struct timespec ts = { (time_t)(rel / 1000000000ull), (long)(rel % 1000000000ull) };
+        nanosleep(&ts, NULL);
+#else
+        struct timespec ts = { (time_t)(sleep_to / 1000000000ull), (long)(sleep_to % 1000000000ull) };
+        // Retry only when a signal cut the sleep short; on any other error the spin below still waits
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+#endif
+    }
+    while (time_now_ns() < wake_ns);
+}
+
+void frame_pacer_init(FramePacer* pacer, double fps, const char* name) {
+    pacer->period_ns = fps > 0.0 ? (uint64_t)(1e9 / fps) : 0;
+    pacer->spin_ns = 500000ull;
+    pacer->work_ns = 0;
+    pacer->frames = 0;
+    pacer->missed = 0;
+    pacer->worst_miss_ns = 0;
+    pacer->late_latch = 1;
+    pacer->name = name;
+    frame_pacer_reset(pacer);
+}
+
+void frame_pacer_wait(FramePacer* pacer) {
+    uint64_t now = time_now_ns();
+    pacer->frames++;
+    if (pacer->period_ns == 0) {
+        pacer->woke_ns = now;
+        return;
+    }
+
+    // Track the frame work time; jump up on spikes, relax slowly
+    uint64_t work = now - pacer->woke_ns;
+    if (work > pacer->work_ns) pacer->work_ns = work;
+    else if (pacer->work_ns > WORK_DECAY_NS) pacer->work_ns -= WORK_DECAY_NS;
+
+    if (now > pacer->deadline_ns) {
+        // Counted, not logged: a print per miss would itself make the next frames late
+        uint64_t overshoot = now - pacer->deadline_ns;
+        pacer->missed++;
+        if (overshoot > pacer->worst_miss_ns) pacer->worst_miss_ns = overshoot;
+
+        // More than a whole period behind: re-anchor instead of rushing to catch up
+        if (now > pacer->deadline_ns + pacer->period_ns) pacer->deadline_ns = now;
+    }
+    pacer->deadline_ns += pacer->period_ns;
+
+    // Wake just early enough to poll input and build the frame before the deadline
+    uint64_t lead = pacer->late_latch ? pacer->work_ns + LATCH_MARGIN_NS : pacer->period_ns;
+    if (lead > pacer->period_ns) lead = pacer->period_ns;
+    sleep_until(pacer->deadline_ns - lead, pacer->spin_ns);
+
+    pacer->woke_ns = time_now_ns();
+}
+
+void frame_pacer_reset(FramePacer* pacer) {
+    pacer->woke_ns = time_now_ns();
+    pacer->deadline_ns = pacer->woke_ns + pacer->period_ns;
+}
+
+void frame_pacer_summary(const FramePacer* pacer) {
+    if (pacer->period_ns == 0 || pacer->frames == 0) return;
+    fprintf(stderr, "%s: %llu frames at %.1f fps target, %llu missed deadlines (%.2f%%), worst by %.3f ms\n", pacer->name,
+        (unsigned long long)pacer->frames, 1e9 / pacer->period_ns, (unsigned long long)pacer->missed,
+        100.0 * pacer->missed / pacer->frames, pacer->worst_miss_ns / 1e6);
+}
@@ -0,0 +1,365 @@
+#include "game.h"
+#include "court.h"
+
+#include <math.h>
+
+#define PADDLE_SPEED 0.02f
+#define BALL_SPEED   0.02f
+#define MAX_BOUNCES  3       // Obstacle contacts resolved per tick; the rest of the move is dropped
+
+// Q16.16 of a constant, rounded to nearest; folded at compile time
+#define FIX(v) ((Fixed)((v) * FIXED_ONE + ((v) < 0 ? -0.5 : 0.5)))
+
+// xorshift32; stands in for rand() so a seed fully determines a match
+static uint32_t game_rand(GameState* state) {
+    uint32_t x = state->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return state->rng = x;
+}
+
+// Copy the fixed-point bodies into the float ones everything else reads; exact, they're well inside float precision
+static void sync_floats(GameState* state) {
+    const float scale = 1.0f / FIXED_ONE;
+    FixedPaddle* fixed_paddles[4] = { &state->fixed.left, &state->fixed.right, &state->fixed.bottom, &state->fixed.top };
+    Paddle* paddles[4] = { &state->left, &state->right, &state->bottom, &state->top };
+    for (int i = 0; i < 4; i++) {
+        *paddles[i] = (Paddle){ fixed_paddles[i]->x * scale, fixed_paddles[i]->y * scale,
+                                fixed_paddles[i]->w * scale, fixed_paddles[i]->h * scale };
+    }
+    const FixedBall* ball = &state->fixed.ball;
+    state->ball = (Ball){ ball->x * scale, ball->y * scale, ball->radius * scale, ball->vx * scale, ball->vy * scale };
+}
+
+// Put the ball back in the middle with a random diagonal
+static void serve_ball(GameState* state) {
+    state->ball.x = state->ball.y = 0.0f;
+    state->ball.vx = (game_rand(state) % 2 ? 0.01f : -0.01f);
+    state->ball.vy = (game_rand(state) % 2 ? 0.015f : -0.015f);
+    state->last_hit = -1;
+    state->serves++;
+    if (state->fixed_point) {
+        state->fixed.ball.x = state->fixed.ball.y = 0;
+        state->fixed.ball.vx = state->ball.vx < 0.0f ? -FIX(0.01) : FIX(0.01);
+        state->fixed.ball.vy = state->ball.vy < 0.0f ? -FIX(0.015) : FIX(0.015);
+    }
+}
+
+void game_init(GameState* state, uint32_t seed) {
+    *state = (GameState){0};
+    state->left = (Paddle){-0.9f, -0.15f, 0.05f, 0.3f};
+    state->right = (Paddle){0.85f, -0.15f, 0.05f, 0.3f};
+    state->bottom = (Paddle){-0.15f, -0.9f, 0.3f, 0.05f};
+    state->top = (Paddle){-0.15f, 0.85f, 0.3f, 0.05f};
+    state->ball.radius = 0.03f;
+    state->players = 2;
+    state->rng = seed ? seed : 1;
+    serve_ball(state);
+}
+
+void game_set_players(GameState* state, int players) {
+    state->players = players < 2 ? 2 : players > GAME_MAX_PLAYERS ? GAME_MAX_PLAYERS : players;
+}
+
+void game_set_fixed_point(GameState* state, int fixed_point) {
+    state->fixed_point = fixed_point;
+    if (!fixed_point) return;
+
+    /* game_init's layout, and the serve it already drew */
+    state->fixed.left = (FixedPaddle){ FIX(-0.9), FIX(-0.15), FIX(0.05), FIX(0.3) };
+    state->fixed.right = (FixedPaddle){ FIX(0.85), FIX(-0.15), FIX(0.05), FIX(0.3) };
+    state->fixed.bottom = (FixedPaddle){ FIX(-0.15), FIX(-0.9), FIX(0.3), FIX(0.05) };
+    state->fixed.top = (FixedPaddle){ FIX(-0.15), FIX(0.85), FIX(0.3), FIX(0.05) };
+    state->fixed.ball = (FixedBall){ 0, 0, FIX(0.03),
+                                     state->ball.vx < 0.0f ? -FIX(0.01) : FIX(0.01),
+                                     state->ball.vy < 0.0f ? -FIX(0.015) : FIX(0.015) };
+    sync_floats(state);
+}
+
+/* One paddle bounce for every side, stamped out per side so the side is all constants:
+   NORMAL is the axis the ball meets the paddle along (x or y) and SIZE the paddle's extent
+   on it (w or h), ALONG / LENGTH the same for the face, FACING +1 for a face looking
+   towards + (left and bottom paddles) and -1 otherwise. The FACING selects fold away, so
+   each side compiles to straight-line code; the arithmetic is the original left / right
+   bounce's, term for term, so two-player matches replay bit for bit. */
+#define DEFINE_PADDLE_BOUNCE(name, NORMAL, SIZE, ALONG, LENGTH, FACING)                                       \
+    static inline int name(Ball* ball, const Paddle* paddle) {                                                \
+        float face = FACING > 0 ? paddle->NORMAL + paddle->SIZE : paddle->NORMAL;                             \
+        int hit = FACING > 0 ? ball->NORMAL - ball->radius <= face : ball->NORMAL + ball->radius >= face;     \
+        if (!hit || ball->ALONG < paddle->ALONG || ball->ALONG > paddle->ALONG + paddle->LENGTH) return 0;    \
+                                                                                                              \
+        float paddleCenter = paddle->ALONG + paddle->LENGTH / 2.0f;                                           \
+        float hitPos = (ball->ALONG - paddleCenter) / (paddle->LENGTH / 2.0f); /* -1 to 1 */                  \
+                                                                                                              \
+        /* Guarantee a minimum sideways speed, and limit the angle so it doesn't go crazzzyyyyy */            \
+        if (fabs(hitPos) < 0.1f) hitPos = (hitPos < 0 ? -0.1f : 0.1f);                                        \
+        if (hitPos > 0.9f) hitPos = 0.9f;                                                                     \
+        if (hitPos < -0.9f) hitPos = -0.9f;                                                                   \
+                                                                                                              \
+        /* New velocity with speed constant */                                                                \
+        ball->v##ALONG = hitPos * fabs(ball->v##NORMAL);                                                      \
+        ball->v##NORMAL = (ball->v##NORMAL < 0 ? 1 : -1) * sqrt(BALL_SPEED * BALL_SPEED / (1 + hitPos * hitPos)); \
+                                                                                                              \
+        /* Prevent Sticking */                                                                                \
+        ball->NORMAL = FACING > 0 ? face + ball->radius : face - ball->radius;                                \
+        return 1;                                                                                             \
+    }
+
+DEFINE_PADDLE_BOUNCE(bounce_left, x, w, y, h, 1)
+DEFINE_PADDLE_BOUNCE(bounce_right, x, w, y, h, -1)
+DEFINE_PADDLE_BOUNCE(bounce_bottom, y, h, x, w, 1)
+DEFINE_PADDLE_BOUNCE(bounce_top, y, h, x, w, -1)
+
+int game_bounce_paddle(Ball* ball, const Paddle* paddle, int left) {
+    return left ? bounce_left(ball, paddle) : bounce_right(ball, paddle);
+}
+
+// Move the ball for one tick, bouncing it off any obstacles on the way
+static void move_ball(GameState* state) {
+    Ball* ball = &state->ball;
+    if (!state->court) {
+        ball->x += ball->vx;
+        ball->y += ball->vy;
+        return;
+    }
+
+    float remaining = 1.0f;
+    for (int bounce = 0; bounce < MAX_BOUNCES; bounce++) {
+        float dx = ball->vx * remaining, dy = ball->vy * remaining;
+        CourtHit hit;
+        if (!court_sweep(state->court, ball->x, ball->y, dx, dy, ball->radius, &hit)) {
+            ball->x += dx;
+            ball->y += dy;
+            return;
+        }
+
+        // Up to the contact, a hair off the surface, then reflect about the normal
+        ball->x += dx * hit.t + hit.nx * 1e-4f;
+        ball->y += dy * hit.t + hit.ny * 1e-4f;
+        float along = ball->vx * hit.nx + ball->vy * hit.ny;
+        ball->vx -= 2.0f * along * hit.nx;
+        ball->vy -= 2.0f * along * hit.ny;
+        remaining *= 1.0f - hit.t;
+    }
+}
+
+void game_move_paddles(GameState* state, unsigned buttons) {
+    Paddle* leftPaddle = &state->left;
+    Paddle* rightPaddle = &state->right;
+
+    // Move Paddles
+    if (buttons & INPUT_LEFT_UP) leftPaddle->y += PADDLE_SPEED;
+    if (buttons & INPUT_LEFT_DOWN) leftPaddle->y -= PADDLE_SPEED;
+    if (buttons & INPUT_RIGHT_UP) rightPaddle->y += PADDLE_SPEED;
+    if (buttons & INPUT_RIGHT_DOWN) rightPaddle->y -= PADDLE_SPEED;
+    // Clamp Paddles
+    if (leftPaddle->y < -1.0f) leftPaddle->y = -1.0f;
+    if (leftPaddle->y + leftPaddle->h > 1.0f) leftPaddle->y = 1.0f - leftPaddle->h;
+    if (rightPaddle->y < -1.0f) rightPaddle->y = -1.0f;
+    if (rightPaddle->y + rightPaddle->h > 1.0f) rightPaddle->y = 1.0f - rightPaddle->h;
+    if (state->players < 3) return;
+
+    Paddle* bottomPaddle = &state->bottom;
+    Paddle* topPaddle = &state->top;
+    if (buttons & INPUT_BOTTOM_LEFT) bottomPaddle->x -= PADDLE_SPEED;
+    if (buttons & INPUT_BOTTOM_RIGHT) bottomPaddle->x += PADDLE_SPEED;
+    if (buttons & INPUT_TOP_LEFT) topPaddle->x -= PADDLE_SPEED;
+    if (buttons & INPUT_TOP_RIGHT) topPaddle->x += PADDLE_SPEED;
+    if (bottomPaddle->x < -1.0f) bottomPaddle->x = -1.0f;
+    if (bottomPaddle->x + bottomPaddle->w > 1.0f) bottomPaddle->x = 1.0f - bottomPaddle->w;
+    if (topPaddle->x < -1.0f) topPaddle->x = -1.0f;
+    if (topPaddle->x + topPaddle->w > 1.0f) topPaddle->x = 1.0f - topPaddle->w;
+}
+
+// A point for getting the ball past a side: the opposite player with two, else the last one to touch it (State, SIDE_*)
+static void score_past(GameState* state, int side) {
+    int scorer = state->players == 2 ? side ^ 1 : state->last_hit;
+    serve_ball(state);
+    if (scorer == side || scorer < 0) return;
+    int* points[GAME_MAX_PLAYERS] = { &state->left_points, &state->right_points, &state->bottom_points, &state->top_points };
+    (*points[scorer])++;
+}
+
+/* Fixed-point core: the float step above redone in Q16.16. Products and quotients go
+   through 64 bits, the square root is a bit-by-bit integer one, and nothing depends on
+   float rounding, so every machine computes the same bits. */
+
+// Divide by 2^16 rounding towards minus infinity; >> on a negative value is implementation-defined in C
+static inline int64_t floor_unscale(int64_t v) {
+    return v >= 0 ? v / FIXED_ONE : -((-v + FIXED_ONE - 1) / FIXED_ONE);
+}
+
+// Product of two Q16.16 values, rounded towards minus infinity
+static inline Fixed fixed_mul(Fixed a, Fixed b) {
+    return (Fixed)floor_unscale((int64_t)a * b);
+}
+
+// Quotient of two Q16.16 values, rounded towards zero
+static inline Fixed fixed_div(Fixed a, Fixed b) {
+    return (Fixed)((int64_t)a * FIXED_ONE / b);
+}
+
+static inline Fixed fixed_abs(Fixed a) {
+    return a < 0 ? -a : a;
+}
+
+// Floor of the square root
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t root = 0, bit = 1ull << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+// DEFINE_PADDLE_BOUNCE in fixed point, same parameters and the same steps
+#define DEFINE_FIXED_BOUNCE(name, NORMAL, SIZE, ALONG, LENGTH, FACING)                                        \
+    static inline int name(FixedBall* ball, const FixedPaddle* paddle) {                                      \
+        Fixed face = FACING > 0 ? paddle->NORMAL + paddle->SIZE : paddle->NORMAL;                             \
+        int hit = FACING > 0 ? ball->NORMAL - ball->radius <= face : ball->NORMAL + ball->radius >= face;     \
+        if (!hit || ball->ALONG < paddle->ALONG || ball->ALONG > paddle->ALONG + paddle->LENGTH) return 0;    \
+                                                                                                              \
+        Fixed half = paddle->LENGTH / 2;                                                                      \
+        Fixed hitPos = fixed_div(ball->ALONG - (paddle->ALONG + half), half); /* -1 to 1 */                   \
+        if (fixed_abs(hitPos) < FIX(0.1)) hitPos = (hitPos < 0 ? -FIX(0.1) : FIX(0.1));                       \
+        if (hitPos > FIX(0.9)) hitPos = FIX(0.9);                                                             \
+        if (hitPos < -FIX(0.9)) hitPos = -FIX(0.9);                                                           \
+                                                                                                              \
+        /* speed^2 / (1 + hitPos^2) in Q32, so its integer square root comes out in Q16 */                    \
+        int64_t speed_sq = (int64_t)FIX(BALL_SPEED) * FIX(BALL_SPEED) * FIXED_ONE;                            \
+        Fixed normal_speed = (Fixed)isqrt64((uint64_t)(speed_sq / (FIXED_ONE + fixed_mul(hitPos, hitPos))));  \
+        ball->v##ALONG = fixed_mul(hitPos, fixed_abs(ball->v##NORMAL));                                       \
+        ball->v##NORMAL = ball->v##NORMAL < 0 ? normal_speed : -normal_speed;                                 \
+                                                                                                              \
+        ball->NORMAL = FACING > 0 ? face + ball->radius : face - ball->radius;                                \
+        return 1;                                                                                             \
+    }
+
+DEFINE_FIXED_BOUNCE(fixed_bounce_left, x, w, y, h, 1)
+DEFINE_FIXED_BOUNCE(fixed_bounce_right, x, w, y, h, -1)
+DEFINE_FIXED_BOUNCE(fixed_bounce_bottom, y, h, x, w, 1)
+DEFINE_FIXED_BOUNCE(fixed_bounce_top, y, h, x, w, -1)
+
+// Keep a paddle on the court along one axis (Position, Length)
+static inline void fixed_clamp_paddle(Fixed* position, Fixed length) {
+    if (*position < -FIXED_ONE) *position = -FIXED_ONE;
+    if (*position + length > FIXED_ONE) *position = FIXED_ONE - length;
+}
+
+static void fixed_step(GameState* state, unsigned buttons) {
+    FixedPaddle* left = &state->fixed.left;
+    FixedPaddle* right = &state->fixed.right;
+    FixedPaddle* bottom = &state->fixed.bottom;
+    FixedPaddle* top = &state->fixed.top;
+    FixedBall* ball = &state->fixed.ball;
+    int guard_bottom = state->players >= 3, guard_top = state->players >= 4;
+
+    /* Paddles */
+    if (buttons & INPUT_LEFT_UP) left->y += FIX(PADDLE_SPEED);
+    if (buttons & INPUT_LEFT_DOWN) left->y -= FIX(PADDLE_SPEED);
+    if (buttons & INPUT_RIGHT_UP) right->y += FIX(PADDLE_SPEED);
+    if (buttons & INPUT_RIGHT_DOWN) right->y -= FIX(PADDLE_SPEED);
+    fixed_clamp_paddle(&left->y, left->h);
+    fixed_clamp_paddle(&right->y, right->h);
+    if (guard_bottom) {
+        if (buttons & INPUT_BOTTOM_LEFT) bottom->x -= FIX(PADDLE_SPEED);
+        if (buttons & INPUT_BOTTOM_RIGHT) bottom->x += FIX(PADDLE_SPEED);
+        if (buttons & INPUT_TOP_LEFT) top->x -= FIX(PADDLE_SPEED);
+        if (buttons & INPUT_TOP_RIGHT) top->x += FIX(PADDLE_SPEED);
+        fixed_clamp_paddle(&bottom->x, bottom->w);
+        fixed_clamp_paddle(&top->x, top->w);
+    }
+
+    /* Ball, unguarded walls, paddles */
+    ball->x += ball->vx;
+    ball->y += ball->vy;
+    if ((ball->y + ball->radius >= FIXED_ONE && !guard_top) || (ball->y - ball->radius <= -FIXED_ONE && !guard_bottom)) ball->vy = -ball->vy;
+
+    int hit = -1;
+    if (fixed_bounce_left(ball, left)) hit = SIDE_LEFT;
+    if (fixed_bounce_right(ball, right)) hit = SIDE_RIGHT;
+    if (guard_bottom && fixed_bounce_bottom(ball, bottom)) hit = SIDE_BOTTOM;
+    if (guard_top && fixed_bounce_top(ball, top)) hit = SIDE_TOP;
+    if (hit >= 0) {
+        state->last_hit = hit;
+        state->paddle_hits++;
+    }
+
+    /* Scoring */
+    if (ball->x < -FIX(1.1)) score_past(state, SIDE_LEFT);
+    if (ball->x > FIX(1.1)) score_past(state, SIDE_RIGHT);
+    if (guard_bottom && ball->y < -FIX(1.1)) score_past(state, SIDE_BOTTOM);
+    if (guard_top && ball->y > FIX(1.1)) score_past(state, SIDE_TOP);
+
+    state->tick++;
+    sync_floats(state);
+}
+
+void game_step(GameState* state, unsigned buttons) {
+    if (state->fixed_point) {
+        fixed_step(state, buttons);
+        return;
+    }
+
+    Paddle* leftPaddle = &state->left;
+    Paddle* rightPaddle = &state->right;
+    Ball* ball = &state->ball;
+
+    game_move_paddles(state, buttons);
+
+
+    // Move Ball
+    move_ball(state);
+
+
+    // Bounce off Top / Bottom, where no one guards them
+    int guard_bottom = state->players >= 3, guard_top = state->players >= 4;
+    if ((ball->y + ball->radius >= 1.0f && !guard_top) || (ball->y - ball->radius <= -1.0f && !guard_bottom)) ball->vy *= -1;
+
+
+    /* Bounce off Paddles */
+    int hit = -1;
+    if (bounce_left(ball, leftPaddle)) hit = SIDE_LEFT;
+    if (bounce_right(ball, rightPaddle)) hit = SIDE_RIGHT;
+    if (guard_bottom && bounce_bottom(ball, &state->bottom)) hit = SIDE_BOTTOM;
+    if (guard_top && bounce_top(ball, &state->top)) hit = SIDE_TOP;
+    if (hit >= 0) {
+        state->last_hit = hit;
+        state->paddle_hits++;
+    }
+
+
+    // Reset if Ball goes too far out any side
+    if (ball->x < -1.1f) score_past(state, SIDE_LEFT);
+    if (ball->x > 1.1f) score_past(state, SIDE_RIGHT);
+    if (guard_bottom && ball->y < -1.1f) score_past(state, SIDE_BOTTOM);
+    if (guard_top && ball->y > 1.1f) score_past(state, SIDE_TOP);
+
+    state->tick++;
+}
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+void game_lerp(GameState* out, const GameState* a, const GameState* b, float t) {
+    *out = *b;
+    out->left.y = lerp(a->left.y, b->left.y, t);
+    out->right.y = lerp(a->right.y, b->right.y, t);
+    out->bottom.x = lerp(a->bottom.x, b->bottom.x, t);
+    out->top.x = lerp(a->top.x, b->top.x, t);
+
+    // A serve teleports the ball; blending across it would smear it over the court
+    if (a->serves == b->serves) {
+        out->ball.x = lerp(a->ball.x, b->ball.x, t);
+        out->ball.y = lerp(a->ball.y, b->ball.y, t);
+    }
+}
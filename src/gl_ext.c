@@ -0,0 +1,173 @@
+#include "gl_ext.h"
+
+#include <stdio.h>
+#include <string.h>
+
+GLExt gl_ext;
+
+// Parse the major/minor numbers out of GL_VERSION
+static void gl_version(int* major, int* minor) {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    *major = *minor = 0;
+    if (version) sscanf(version, "%d.%d", major, minor);
+}
+
+static int gl_at_least(int major, int minor) {
+    int have_major, have_minor;
+    gl_version(&have_major, &have_minor);
+    return have_major > major || (have_major == major && have_minor >= minor);
+}
+
+#define LOAD(field, name) (*(void**)&gl_ext.field = (void*)glfwGetProcAddress(name))
+
+void gl_ext_load(void) {
+    memset(&gl_ext, 0, sizeof(gl_ext));
+
+    // Fence sync (GL 3.2 / ARB_sync)
+    if (gl_at_least(3, 2) || glfwExtensionSupported("GL_ARB_sync")) {
+        LOAD(fence_sync, "glFenceSync");
+        LOAD(client_wait_sync, "glClientWaitSync");
+        LOAD(delete_sync, "glDeleteSync");
+        gl_ext.has_sync = gl_ext.fence_sync && gl_ext.client_wait_sync && gl_ext.delete_sync;
+    }
+
+    if (gl_at_least(1, 5) || glfwExtensionSupported("GL_ARB_vertex_buffer_object")) {
+        LOAD(gen_buffers, "glGenBuffers");
+        LOAD(delete_buffers, "glDeleteBuffers");
+        LOAD(bind_buffer, "glBindBuffer");
+        LOAD(buffer_data, "glBufferData");
+        gl_ext.has_vbo = gl_ext.gen_buffers && gl_ext.delete_buffers && gl_ext.bind_buffer && gl_ext.buffer_data;
+    }
+
+    if (gl_ext.has_vbo && (gl_at_least(2, 1) || glfwExtensionSupported("GL_ARB_pixel_buffer_object"))) {
+        LOAD(map_buffer, "glMapBuffer");
+        LOAD(unmap_buffer, "glUnmapBuffer");
+        gl_ext.has_pbo = gl_ext.map_buffer && gl_ext.unmap_buffer;
+    }
+
+    if (gl_at_least(3, 0) || glfwExtensionSupported("GL_ARB_framebuffer_object")) {
+        LOAD(gen_framebuffers, "glGenFramebuffers");
+        LOAD(delete_framebuffers, "glDeleteFramebuffers");
+        LOAD(bind_framebuffer, "glBindFramebuffer");
+        LOAD(framebuffer_texture_2d, "glFramebufferTexture2D");
+        LOAD(check_framebuffer_status, "glCheckFramebufferStatus");
+    } else if (glfwExtensionSupported("GL_EXT_framebuffer_object")) {
+        LOAD(gen_framebuffers, "glGenFramebuffersEXT");
+        LOAD(delete_framebuffers, "glDeleteFramebuffersEXT");
+        LOAD(bind_framebuffer, "glBindFramebufferEXT");
+        LOAD(framebuffer_texture_2d, "glFramebufferTexture2DEXT");
+        LOAD(check_framebuffer_status, "glCheckFramebufferStatusEXT");
+    }
+    gl_ext.has_fbo = gl_ext.gen_framebuffers && gl_ext.delete_framebuffers && gl_ext.bind_framebuffer &&
+        gl_ext.framebuffer_texture_2d && gl_ext.check_framebuffer_status;
+
+    // Query objects themselves are GL 1.5; only the 64-bit result getter differs
+    if (gl_at_least(3, 3) || glfwExtensionSupported("GL_ARB_timer_query")) {
+        LOAD(get_query_objectui64v, "glGetQueryObjectui64v");
+    } else if (glfwExtensionSupported("GL_EXT_timer_query")) {
+        LOAD(get_query_objectui64v, "glGetQueryObjectui64vEXT");
+    }
+    if (gl_ext.get_query_objectui64v && gl_at_least(1, 5)) {
+        LOAD(gen_queries, "glGenQueries");
+        LOAD(delete_queries, "glDeleteQueries");
+        LOAD(begin_query, "glBeginQuery");
+        LOAD(end_query, "glEndQuery");
+        LOAD(get_query_objectiv, "glGetQueryObjectiv");
+        gl_ext.has_timer_query = gl_ext.gen_queries && gl_ext.delete_queries && gl_ext.begin_query &&
+            gl_ext.end_query && gl_ext.get_query_objectiv;
+    }
+
+    if (gl_at_least(2, 0)) {
+        LOAD(create_shader, "glCreateShader");
+        LOAD(shader_source, "glShaderSource");
+        LOAD(compile_shader, "glCompileShader");
+        LOAD(get_shaderiv, "glGetShaderiv");
+        LOAD(get_shader_info_log, "glGetShaderInfoLog");
+        LOAD(delete_shader, "glDeleteShader");
+        LOAD(create_program, "glCreateProgram");
+        LOAD(delete_program, "glDeleteProgram");
+        LOAD(attach_shader, "glAttachShader");
+        LOAD(link_program, "glLinkProgram");
+        LOAD(get_programiv, "glGetProgramiv");
+        LOAD(get_program_info_log, "glGetProgramInfoLog");
+        LOAD(use_program, "glUseProgram");
+        LOAD(get_uniform_location, "glGetUniformLocation");
+        LOAD(uniform1i, "glUniform1i");
+        LOAD(get_attrib_location, "glGetAttribLocation");
+        LOAD(vertex_attrib_pointer, "glVertexAttribPointer");
+        LOAD(enable_vertex_attrib_array, "glEnableVertexAttribArray");
+        LOAD(disable_vertex_attrib_array, "glDisableVertexAttribArray");
+        gl_ext.has_shaders = gl_ext.create_shader && gl_ext.shader_source && gl_ext.compile_shader &&
+            gl_ext.get_shaderiv && gl_ext.get_shader_info_log && gl_ext.delete_shader && gl_ext.create_program &&
+            gl_ext.delete_program && gl_ext.attach_shader && gl_ext.link_program && gl_ext.get_programiv && gl_ext.get_program_info_log &&
+            gl_ext.use_program && gl_ext.get_uniform_location && gl_ext.uniform1i && gl_ext.get_attrib_location &&
+            gl_ext.vertex_attrib_pointer && gl_ext.enable_vertex_attrib_array && gl_ext.disable_vertex_attrib_array;
+    }
+
+    if (gl_ext.has_shaders && gl_ext.has_vbo) {
+        if (gl_at_least(3, 3)) {
+            LOAD(draw_arrays_instanced, "glDrawArraysInstanced");
+            LOAD(vertex_attrib_divisor, "glVertexAttribDivisor");
+        } else if (glfwExtensionSupported("GL_ARB_instanced_arrays")) {
+            LOAD(vertex_attrib_divisor, "glVertexAttribDivisorARB");
+            if (gl_at_least(3, 1)) LOAD(draw_arrays_instanced, "glDrawArraysInstanced");
+            else if (glfwExtensionSupported("GL_ARB_draw_instanced")) LOAD(draw_arrays_instanced, "glDrawArraysInstancedARB");
+        }
+        gl_ext.has_instancing = gl_ext.draw_arrays_instanced && gl_ext.vertex_attrib_divisor;
+    }
+
+    // Persistent mapping is useless without fences to know when a region is free again
+    if (gl_ext.has_vbo && gl_ext.has_sync && (gl_at_least(4, 4) || glfwExtensionSupported("GL_ARB_buffer_storage"))) {
+        LOAD(buffer_storage, "glBufferStorage");
+        LOAD(map_buffer_range, "glMapBufferRange");
+        gl_ext.has_buffer_storage = gl_ext.buffer_storage && gl_ext.map_buffer_range;
+    }
+}
+
+static GLuint compile_stage(GLenum type, const char* source) {
+    GLuint shader = gl_ext.create_shader(type);
+    gl_ext.shader_source(shader, 1, &source, NULL);
+    gl_ext.compile_shader(shader);
+
+    GLint ok = 0;
+    gl_ext.get_shaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        gl_ext.get_shader_info_log(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Shader compile failed: %s\n", log);
+        gl_ext.delete_shader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint gl_ext_build_program(const char* vertex_source, const char* fragment_source) {
+    if (!gl_ext.has_shaders) return 0;
+
+    GLuint vertex = vertex_source ? compile_stage(GL_VERTEX_SHADER, vertex_source) : 0;
+    GLuint fragment = compile_stage(GL_FRAGMENT_SHADER, fragment_source);
+    if ((vertex_source && !vertex) || !fragment) {
+        // One stage may have compiled; don't leak it
+        if (vertex) gl_ext.delete_shader(vertex);
+        if (fragment) gl_ext.delete_shader(fragment);
+        return 0;
+    }
+
+    GLuint program = gl_ext.create_program();
+    if (vertex) gl_ext.attach_shader(program, vertex);
+    gl_ext.attach_shader(program, fragment);
+    gl_ext.link_program(program);
+    if (vertex) gl_ext.delete_shader(vertex);
+    gl_ext.delete_shader(fragment);
+
+    GLint ok = 0;
+    gl_ext.get_programiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        gl_ext.get_program_info_log(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Program link failed: %s\n", log);
+        gl_ext.delete_program(program);
+        return 0;
+    }
+    return program;
+}
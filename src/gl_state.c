@@ -0,0 +1,238 @@
+#include "gl_state.h"
+#include "gl_ext.h"
+
+#include <stdio.h>
+#include <string.h>
+
+GLStateStats gls_stats;
+int gls_debug = 0;
+
+// Caps the cache knows about; anything else passes straight through
+static const GLenum tracked_caps[] = { GL_TEXTURE_2D, GL_BLEND, GL_DEPTH_TEST, GL_ALPHA_TEST };
+#define CAP_COUNT (sizeof(tracked_caps) / sizeof(tracked_caps[0]))
+
+static struct {
+    int texture_known;
+    GLuint texture;
+    unsigned caps_known;   // Bit per tracked_caps entry
+    unsigned caps_on;
+    int blend_known;
+    GLenum blend_src, blend_dst;
+    int color_known;
+    float color[4];
+    int program_known;
+    GLuint program;
+    int sharpen_known;
+    int sharpen;
+    int alpha_func_known;
+    GLenum alpha_func;
+    float alpha_ref;
+} cache;
+
+#define MAX_TEXTURE_PROFILES 8
+
+// Per-texture draw state registered by gls_register_texture
+static struct {
+    GLuint texture;
+    GLuint program;
+    float alpha_ref;
+} profiles[MAX_TEXTURE_PROFILES];
+static int profile_count;
+
+static int cap_index(GLenum cap) {
+    for (unsigned i = 0; i < CAP_COUNT; i++) if (tracked_caps[i] == cap) return (int)i;
+    return -1;
+}
+
+void gls_invalidate(void) {
+    memset(&cache, 0, sizeof(cache));
+}
+
+void gls_invalidate_color(void) {
+    cache.color_known = 0;
+}
+
+void gls_bind_texture(GLuint texture) {
+    if (cache.texture_known && cache.texture == texture) {
+        gls_stats.elided++;
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    cache.texture_known = 1;
+    cache.texture = texture;
+    gls_stats.issued++;
+}
+
+static void set_cap(GLenum cap, int on) {
+    int index = cap_index(cap);
+    if (index < 0) {
+        if (on) glEnable(cap);
+        else glDisable(cap);
+        gls_stats.issued++;
+        return;
+    }
+
+    unsigned bit = 1u << index;
+    if ((cache.caps_known & bit) && !!(cache.caps_on & bit) == on) {
+        gls_stats.elided++;
+        return;
+    }
+    if (on) glEnable(cap);
+    else glDisable(cap);
+    cache.caps_known |= bit;
+    cache.caps_on = on ? cache.caps_on | bit : cache.caps_on & ~bit;
+    gls_stats.issued++;
+}
+
+void gls_enable(GLenum cap) {
+    set_cap(cap, 1);
+}
+
+void gls_disable(GLenum cap) {
+    set_cap(cap, 0);
+}
+
+void gls_blend_func(GLenum src, GLenum dst) {
+    if (cache.blend_known && cache.blend_src == src && cache.blend_dst == dst) {
+        gls_stats.elided++;
+        return;
+    }
+    glBlendFunc(src, dst);
+    cache.blend_known = 1;
+    cache.blend_src = src;
+    cache.blend_dst = dst;
+    gls_stats.issued++;
+}
+
+// Safe inside glBegin / glEnd: the current color is plain vertex state
+void gls_color4f(float r, float g, float b, float a) {
+    if (cache.color_known && cache.color[0] == r && cache.color[1] == g && cache.color[2] == b && cache.color[3] == a) {
+        gls_stats.elided++;
+        return;
+    }
+    glColor4f(r, g, b, a);
+    cache.color_known = 1;
+    cache.color[0] = r; cache.color[1] = g; cache.color[2] = b; cache.color[3] = a;
+    gls_stats.issued++;
+}
+
+void gls_use_program(GLuint program) {
+    if (!gl_ext.has_shaders) return;
+    if (cache.program_known && cache.program == program) {
+        gls_stats.elided++;
+        return;
+    }
+    gl_ext.use_program(program);
+    cache.program_known = 1;
+    cache.program = program;
+    gls_stats.issued++;
+}
+
+void gls_alpha_func(GLenum func, float ref) {
+    if (cache.alpha_func_known && cache.alpha_func == func && cache.alpha_ref == ref) {
+        gls_stats.elided++;
+        return;
+    }
+    glAlphaFunc(func, ref);
+    cache.alpha_func_known = 1;
+    cache.alpha_func = func;
+    cache.alpha_ref = ref;
+    gls_stats.issued++;
+}
+
+void gls_register_texture(GLuint texture, GLuint program, float alpha_ref) {
+    for (int i = 0; i < profile_count; i++) {
+        if (profiles[i].texture == texture) {
+            profiles[i].program = program;
+            profiles[i].alpha_ref = alpha_ref;
+            return;
+        }
+    }
+    if (profile_count == MAX_TEXTURE_PROFILES) return;
+    profiles[profile_count].texture = texture;
+    profiles[profile_count].program = program;
+    profiles[profile_count].alpha_ref = alpha_ref;
+    profile_count++;
+}
+
+#ifndef GL_COMBINE
+#define GL_COMBINE       0x8570
+#define GL_COMBINE_RGB   0x8571
+#define GL_COMBINE_ALPHA 0x8572
+#define GL_RGB_SCALE     0x8573
+#define GL_SUBTRACT      0x84E7
+#define GL_CONSTANT      0x8576
+#define GL_SOURCE0_RGB   0x8580
+#define GL_SOURCE1_RGB   0x8581
+#define GL_SOURCE0_ALPHA 0x8588
+#endif
+
+// Texture env for alpha-tested distance fields: rgb = 4 * (tex - 0.375), a steep ramp centred on 0.5
+static void set_sharpen(int on) {
+    if (cache.sharpen_known && cache.sharpen == on) {
+        gls_stats.elided++;
+        return;
+    }
+    if (on) {
+        static const float bias[4] = { 0.375f, 0.375f, 0.375f, 0.0f };
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_SUBTRACT);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_CONSTANT);
+        glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, bias);
+        glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, 4.0f);
+        glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+    } else {
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    }
+    cache.sharpen_known = 1;
+    cache.sharpen = on;
+    gls_stats.issued++;
+}
+
+void gls_texture_state(GLuint texture) {
+    GLuint program = 0;
+    float alpha_ref = 0.0f;
+
+    if (texture) {
+        for (int i = 0; i < profile_count; i++) {
+            if (profiles[i].texture == texture) {
+                program = profiles[i].program;
+                alpha_ref = profiles[i].alpha_ref;
+                break;
+            }
+        }
+        gls_enable(GL_TEXTURE_2D);
+        gls_bind_texture(texture);
+    } else {
+        gls_disable(GL_TEXTURE_2D);
+    }
+
+    // Alpha-tested glyphs draw opaque; blending their 0.5..1 alpha would soften the edge again
+    gls_use_program(program);
+    if (alpha_ref > 0.0f) {
+        gls_alpha_func(GL_GEQUAL, alpha_ref);
+        gls_enable(GL_ALPHA_TEST);
+        gls_disable(GL_BLEND);
+        set_sharpen(1);
+    } else {
+        gls_disable(GL_ALPHA_TEST);
+        gls_enable(GL_BLEND);
+        if (texture) set_sharpen(0);
+    }
+}
+
+void gls_frame_end(void) {
+    gls_stats.frames++;
+    gls_stats.total_issued += gls_stats.issued;
+    gls_stats.total_elided += gls_stats.elided;
+
+    if (gls_debug && gls_stats.frames % 60 == 0) {
+        fprintf(stderr, "gl_state: frame %llu: %u issued, %u elided (%.1f elided/frame avg)\n",
+            gls_stats.frames, gls_stats.issued, gls_stats.elided,
+            (double)gls_stats.total_elided / gls_stats.frames);
+    }
+    gls_stats.issued = 0;
+    gls_stats.elided = 0;
+}
@@ -0,0 +1,268 @@
+#include "glyph_cache.h"
+#include "gl_state.h"
+#include "text.h"
+#include "ttf.h"
+#include "vertex_stream.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TABLE_SIZE 2048   // Power of two, comfortably above what GLYPH_PAGES can hold
+#define MAX_SHELVES 64
+#define GLYPH_KEY   0x80000000u   // Table keys with this bit are glyph indices, not code points
+
+GlyphCacheStats glyph_cache_stats;
+
+typedef struct {
+    int y, height, x;
+} Shelf;
+
+typedef struct {
+    GLuint texture;
+    Shelf shelves[MAX_SHELVES];
+    int shelf_count;
+    int bottom;                 // First row below the last shelf
+    unsigned long long last_used;
+} GlyphPage;
+
+static struct {
+    int active;
+    TTFont font;
+    GlyphPage pages[GLYPH_PAGES];
+    CachedGlyph table[TABLE_SIZE];
+    unsigned char used[TABLE_SIZE];
+    int count;
+    unsigned long long clock;   // Bumped on every lookup; drives page LRU
+} cache;
+
+static unsigned slot_for(uint32_t codepoint) {
+    return (codepoint * 2654435761u) & (TABLE_SIZE - 1);
+}
+
+static CachedGlyph* table_find(uint32_t codepoint) {
+    for (unsigned i = slot_for(codepoint);; i = (i + 1) & (TABLE_SIZE - 1)) {
+        if (!cache.used[i]) return NULL;
+        if (cache.table[i].codepoint == codepoint) return &cache.table[i];
+    }
+}
+
+static CachedGlyph* table_insert(const CachedGlyph* glyph) {
+    unsigned i = slot_for(glyph->codepoint);
+    while (cache.used[i]) i = (i + 1) & (TABLE_SIZE - 1);
+    cache.used[i] = 1;
+    cache.table[i] = *glyph;
+    cache.count++;
+    return &cache.table[i];
+}
+
+// Drop every glyph living on a page; rehash the survivors so probe chains stay intact
+static void table_remove_page(int page) {
+    static CachedGlyph keep[TABLE_SIZE];
+    int count = 0;
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        if (cache.used[i] && cache.table[i].page != page) keep[count++] = cache.table[i];
+    }
+    memset(cache.used, 0, sizeof(cache.used));
+    cache.count = 0;
+    for (int i = 0; i < count; i++) table_insert(&keep[i]);
+}
+
+// Create the atlas pages once cache.font is loaded
+static int create_pages(void) {
+    for (int i = 0; i < GLYPH_PAGES; i++) {
+        GlyphPage* page = &cache.pages[i];
+        glGenTextures(1, &page->texture);
+        gls_bind_texture(page->texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        register_sdf_texture(page->texture, 0.0f);
+    }
+    cache.active = 1;
+    return 1;
+}
+
+int glyph_cache_init(const char* ttf_path) {
+    memset(&cache, 0, sizeof(cache));
+    if (!ttf_load(&cache.font, ttf_path)) return 0;
+    return create_pages();
+}
+
+int glyph_cache_init_memory(const unsigned char* data, uint32_t size) {
+    memset(&cache, 0, sizeof(cache));
+    if (!ttf_load_memory(&cache.font, data, size)) return 0;
+    return create_pages();
+}
+
+void glyph_cache_shutdown(void) {
+    if (!cache.active) return;
+    for (int i = 0; i < GLYPH_PAGES; i++) glDeleteTextures(1, &cache.pages[i].texture);
+    ttf_free(&cache.font);
+    cache.active = 0;
+}
+
+int glyph_cache_active(void) {
+    return cache.active;
+}
+
+float glyph_cache_ascent(void) {
+    return (float)cache.font.ascent / (float)(cache.font.ascent - cache.font.descent);
+}
+
+// Find room on a page's shelves (Page, Width, Height, Out X, Out Y); returns 0 when full
+static int page_alloc(GlyphPage* page, int w, int h, int* x, int* y) {
+    for (int i = 0; i < page->shelf_count; i++) {
+        Shelf* shelf = &page->shelves[i];
+        if (h <= shelf->height && shelf->x + w <= GLYPH_PAGE_SIZE) {
+            *x = shelf->x;
+            *y = shelf->y;
+            shelf->x += w;
+            return 1;
+        }
+    }
+    if (page->shelf_count == MAX_SHELVES || page->bottom + h > GLYPH_PAGE_SIZE || w > GLYPH_PAGE_SIZE) return 0;
+
+    Shelf* shelf = &page->shelves[page->shelf_count++];
+    shelf->y = page->bottom;
+    shelf->height = h;
+    shelf->x = w;
+    page->bottom += h;
+    *x = 0;
+    *y = shelf->y;
+    return 1;
+}
+
+// Coverage -> two-channel distance field (both channels equal; TTF glyphs have no outline)
+static unsigned char* coverage_to_sdf(const unsigned char* coverage, int w, int h) {
+    unsigned char* sdf = malloc((size_t)w * h * 2);
+    if (!sdf) return NULL;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int c = coverage[y * w + x];
+            int inside = c >= 128;
+            float d;
+
+            if (c > 0 && c < 255) {
+                d = 0.5f - c / 255.0f;   // Edge pixel: coverage already says where the edge is
+            } else {
+                float best = (float)GLYPH_PAD + 1.0f;
+                for (int qy = y - GLYPH_PAD; qy <= y + GLYPH_PAD; qy++) {
+                    for (int qx = x - GLYPH_PAD; qx <= x + GLYPH_PAD; qx++) {
+                        int other = qx >= 0 && qy >= 0 && qx < w && qy < h && coverage[qy * w + qx] >= 128;
+                        if (other == inside) continue;
+                        float dist = sqrtf((float)((qx - x) * (qx - x) + (qy - y) * (qy - y)));
+                        if (dist < best) best = dist;
+                    }
+                }
+                d = inside ? -(best - 0.5f) : best - 0.5f;
+            }
+
+            float v = 0.5f - d / (2.0f * GLYPH_PAD);
+            if (v < 0.0f) v = 0.0f;
+            if (v > 1.0f) v = 1.0f;
+            sdf[(y * w + x) * 2] = sdf[(y * w + x) * 2 + 1] = (unsigned char)(v * 255.0f + 0.5f);
+        }
+    }
+    return sdf;
+}
+
+// Wipe the least recently used page and hand it back empty
+static int evict_page(void) {
+    int victim = 0;
+    for (int i = 1; i < GLYPH_PAGES; i++) {
+        if (cache.pages[i].last_used < cache.pages[victim].last_used) victim = i;
+    }
+
+    // Quads already queued this frame may still point at the old contents
+    stream_flush();
+
+    GlyphPage* page = &cache.pages[victim];
+    page->shelf_count = 0;
+    page->bottom = 0;
+    table_remove_page(victim);
+    glyph_cache_stats.evictions++;
+    return victim;
+}
+
+static CachedGlyph* rasterize(uint32_t codepoint) {
+    // Blank entries never leave with a page; start over before the table clogs up
+    if (cache.count >= TABLE_SIZE * 3 / 4) {
+        stream_flush();
+        for (int i = 0; i < GLYPH_PAGES; i++) cache.pages[i].shelf_count = cache.pages[i].bottom = 0;
+        memset(cache.used, 0, sizeof(cache.used));
+        cache.count = 0;
+        glyph_cache_stats.evictions += GLYPH_PAGES;
+    }
+
+    CachedGlyph glyph = { .codepoint = codepoint, .page = -1 };
+    int index = ttf_glyph_index(&cache.font, codepoint);
+
+    // Code points sharing a glyph (every missing one maps to .notdef) share one bitmap
+    CachedGlyph* shared = table_find(GLYPH_KEY | (uint32_t)index);
+    if (shared) {
+        glyph = *shared;
+        glyph.codepoint = codepoint;
+        return table_insert(&glyph);
+    }
+
+    TTGlyphBitmap bitmap;
+    ttf_rasterize(&cache.font, index, GLYPH_LINE_PX, GLYPH_PAD, &bitmap);
+    glyph.advance = bitmap.advance / GLYPH_LINE_PX;
+    if (!bitmap.coverage) return table_insert(&glyph);
+
+    int x, y, page = -1;
+    for (int i = 0; i < GLYPH_PAGES && page < 0; i++) {
+        if (page_alloc(&cache.pages[i], bitmap.width, bitmap.height, &x, &y)) page = i;
+    }
+    if (page < 0) {
+        page = evict_page();
+        if (!page_alloc(&cache.pages[page], bitmap.width, bitmap.height, &x, &y)) {
+            free(bitmap.coverage);
+            return table_insert(&glyph);
+        }
+    }
+
+    unsigned char* sdf = coverage_to_sdf(bitmap.coverage, bitmap.width, bitmap.height);
+    if (!sdf) {
+        free(bitmap.coverage);
+        return table_insert(&glyph);
+    }
+    stream_flush();
+    gls_bind_texture(cache.pages[page].texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, bitmap.width, bitmap.height, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, sdf);
+    free(sdf);
+    free(bitmap.coverage);
+
+    glyph.page = page;
+    glyph.texture = cache.pages[page].texture;
+    glyph.u0 = (float)x / GLYPH_PAGE_SIZE;
+    glyph.v0 = (float)y / GLYPH_PAGE_SIZE;
+    glyph.u1 = (float)(x + bitmap.width) / GLYPH_PAGE_SIZE;
+    glyph.v1 = (float)(y + bitmap.height) / GLYPH_PAGE_SIZE;
+    glyph.left = bitmap.left / GLYPH_LINE_PX;
+    glyph.top = bitmap.top / GLYPH_LINE_PX;
+    glyph.width = bitmap.width / GLYPH_LINE_PX;
+    glyph.height = bitmap.height / GLYPH_LINE_PX;
+
+    CachedGlyph by_index = glyph;
+    by_index.codepoint = GLYPH_KEY | (uint32_t)index;
+    table_insert(&by_index);
+    return table_insert(&glyph);
+}
+
+const CachedGlyph* glyph_cache_get(uint32_t codepoint) {
+    if (!cache.active) return NULL;
+    cache.clock++;
+
+    CachedGlyph* glyph = table_find(codepoint);
+    if (glyph) {
+        glyph_cache_stats.hits++;
+    } else {
+        glyph_cache_stats.misses++;
+        glyph = rasterize(codepoint);
+    }
+    if (glyph->page >= 0) cache.pages[glyph->page].last_used = cache.clock;
+    return glyph;
+}
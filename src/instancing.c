@@ -0,0 +1,202 @@
+#include "instancing.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "sdf.h"
+#include "text.h"
+#include "vertex_stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+
+#define INSTANCE_RESERVE 8192    // Queued up front so gameplay frames never grow the queue: a full particle pool plus a scene
+
+InstancingStats instancing_stats;
+
+// Corner in 0..1 picks a point of the instance's rectangle and atlas cell
+static const char* instance_vertex_source =
+    "attribute vec2 corner;\n"
+    "attribute vec4 rect;\n"
+    "attribute vec4 uv;\n"
+    "attribute vec4 color;\n"
+    "varying vec2 tex;\n"
+    "varying vec4 tint;\n"
+    "varying float textured;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(mix(rect.xy, rect.zw, corner), 0.0, 1.0);\n"
+    "    tex = mix(uv.xy, uv.zw, corner);\n"
+    "    tint = color;\n"
+    "    textured = step(0.0, uv.x);\n"
+    "}\n";
+
+// Same distance field shading as text.c; derivatives are taken before choosing, so they stay defined
+static const char* instance_fragment_source =
+    "uniform sampler2D atlas;\n"
+    "varying vec2 tex;\n"
+    "varying vec4 tint;\n"
+    "varying float textured;\n"
+    "void main() {\n"
+    "    vec4 t = texture2D(atlas, tex);\n"
+    "    float w = max(fwidth(t.a) * 0.7, 0.001);\n"
+    "    float alpha = smoothstep(0.5 - w, 0.5 + w, t.a);\n"
+    "    float fill = smoothstep(0.5 - w, 0.5 + w, t.r);\n"
+    "    gl_FragColor = mix(tint, vec4(tint.rgb * fill, tint.a * alpha), textured);\n"
+    "}\n";
+
+enum { ATTR_CORNER, ATTR_RECT, ATTR_UV, ATTR_COLOR, ATTR_COUNT };
+static const char* attribute_names[ATTR_COUNT] = { "corner", "rect", "uv", "color" };
+
+static struct {
+    int active;
+    GLuint program;
+    GLint attributes[ATTR_COUNT];
+    GLuint corner_buffer;
+    GLuint instance_buffer;
+    QuadInstance* queue;
+    unsigned count, capacity;
+} inst;
+
+int instancing_init(void) {
+    if (!gl_ext.has_instancing) return 0;
+
+    inst.program = gl_ext_build_program(instance_vertex_source, instance_fragment_source);
+    if (!inst.program) return 0;
+    for (int i = 0; i < ATTR_COUNT; i++) {
+        inst.attributes[i] = gl_ext.get_attrib_location(inst.program, attribute_names[i]);
+        if (inst.attributes[i] < 0) {
+            fprintf(stderr, "instancing: attribute %s missing\n", attribute_names[i]);
+            gl_ext.delete_program(inst.program);
+            inst.program = 0;
+            return 0;
+        }
+    }
+    gls_use_program(inst.program);
+    gl_ext.uniform1i(gl_ext.get_uniform_location(inst.program, "atlas"), 0);
+    gls_use_program(0);
+
+    static const float corners[8] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    gl_ext.gen_buffers(1, &inst.corner_buffer);
+    gl_ext.bind_buffer(GL_ARRAY_BUFFER, inst.corner_buffer);
+    gl_ext.buffer_data(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    gl_ext.gen_buffers(1, &inst.instance_buffer);
+    stream_bind_arrays();
+
+    inst.queue = malloc(INSTANCE_RESERVE * sizeof(QuadInstance));
+    inst.capacity = inst.queue ? INSTANCE_RESERVE : 0;
+
+    inst.active = 1;
+    return 1;
+}
+
+void instancing_shutdown(void) {
+    if (!inst.active) return;
+    gl_ext.delete_buffers(1, &inst.corner_buffer);
+    gl_ext.delete_buffers(1, &inst.instance_buffer);
+    gl_ext.delete_program(inst.program);
+    free(inst.queue);
+    memset(&inst, 0, sizeof(inst));
+}
+
+int instancing_active(void) {
+    return inst.active;
+}
+
+static QuadInstance* push(void) {
+    if (inst.count == inst.capacity) {
+        unsigned capacity = inst.capacity ? inst.capacity * 2 : 1024;
+        QuadInstance* queue = realloc(inst.queue, capacity * sizeof(QuadInstance));
+        if (!queue) return NULL;
+        inst.queue = queue;
+        inst.capacity = capacity;
+    }
+    return &inst.queue[inst.count++];
+}
+
+static unsigned char to_byte(float v) {
+    return (unsigned char)(v <= 0.0f ? 0 : v >= 1.0f ? 255 : v * 255.0f + 0.5f);
+}
+
+void instance_rect(float x, float y, float w, float h, float r, float g, float b, float a) {
+    QuadInstance* q = push();
+    if (!q) return;
+    *q = (QuadInstance){ { x, y, x + w, y + h }, { -1.0f, -1.0f, -1.0f, -1.0f },
+        { to_byte(r), to_byte(g), to_byte(b), to_byte(a) } };
+}
+
+void instance_text(const char* text, float x, float y, float size) {
+    for (; *text; text++, x += size) {
+        int index = font_index((unsigned char)*text);
+        if (index < 0) continue;
+        QuadInstance* q = push();
+        if (!q) return;
+
+        // Atlas rows run top-down like font.png, so the glyph's bottom edge gets the larger v
+        float u0 = (float)(index % FONT_COLS) / FONT_COLS, u1 = u0 + 1.0f / FONT_COLS;
+        float v0 = (float)(index / FONT_COLS) / FONT_ROWS, v1 = v0 + 1.0f / FONT_ROWS;
+        *q = (QuadInstance){ { x, y - size, x + size, y }, { u0, v1, u1, v0 }, { 255, 255, 255, 255 } };
+    }
+}
+
+void instance_scene(const Scene* scene) {
+    for (int i = 0; i < scene->rect_count; i++) {
+        const SceneRect* rect = &scene->rects[i];
+        instance_rect(rect->x, rect->y, rect->w, rect->h, rect->r, rect->g, rect->b, rect->a);
+    }
+    for (int i = 0; i < scene->text_count; i++) {
+        const SceneText* text = &scene->texts[i];
+        instance_text(text->text, text->x - strlen(text->text) * text->size / 2.0f, text->y, text->size);
+    }
+}
+
+void instancing_flush(void) {
+    if (!inst.active || inst.count == 0) return;
+
+    stream_flush();
+    gls_bind_texture(font_texture);
+    gls_use_program(inst.program);
+    gls_enable(GL_BLEND);
+    gls_disable(GL_ALPHA_TEST);
+
+    gl_ext.bind_buffer(GL_ARRAY_BUFFER, inst.corner_buffer);
+    gl_ext.vertex_attrib_pointer(inst.attributes[ATTR_CORNER], 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    gl_ext.enable_vertex_attrib_array(inst.attributes[ATTR_CORNER]);
+
+    // Orphaned every flush, so the driver never waits for last frame's draw
+    gl_ext.bind_buffer(GL_ARRAY_BUFFER, inst.instance_buffer);
+    gl_ext.buffer_data(GL_ARRAY_BUFFER, inst.count * sizeof(QuadInstance), inst.queue, GL_STREAM_DRAW);
+    gl_ext.vertex_attrib_pointer(inst.attributes[ATTR_RECT], 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)offsetof(QuadInstance, rect));
+    gl_ext.vertex_attrib_pointer(inst.attributes[ATTR_UV], 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)offsetof(QuadInstance, uv));
+    gl_ext.vertex_attrib_pointer(inst.attributes[ATTR_COLOR], 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadInstance), (void*)offsetof(QuadInstance, color));
+    for (int i = ATTR_RECT; i < ATTR_COUNT; i++) {
+        gl_ext.enable_vertex_attrib_array(inst.attributes[i]);
+        gl_ext.vertex_attrib_divisor(inst.attributes[i], 1);
+    }
+
+    gl_ext.draw_arrays_instanced(GL_TRIANGLE_STRIP, 0, 4, inst.count);
+
+    /* Some drivers alias generic slots onto the fixed-function arrays, so hand them back to the stream */
+    for (int i = 0; i < ATTR_COUNT; i++) {
+        gl_ext.vertex_attrib_divisor(inst.attributes[i], 0);
+        gl_ext.disable_vertex_attrib_array(inst.attributes[i]);
+    }
+    stream_bind_arrays();
+    gls_invalidate_color();
+
+    instancing_stats.instances += inst.count;
+    instancing_stats.draws++;
+    inst.count = 0;
+}
+
+void instancing_end_frame(void) {
+    if (!inst.active) return;
+    instancing_flush();
+    if (gls_debug && (gls_stats.frames + 1) % 60 == 0) {
+        fprintf(stderr, "instancing: %u instances in %u draws this frame\n", instancing_stats.instances, instancing_stats.draws);
+    }
+    instancing_stats.instances = 0;
+    instancing_stats.draws = 0;
+}
@@ -0,0 +1,182 @@
+#include "latency.h"
+#include "gl_ext.h"
+#include "utils.h"
+
+#include <GLFW/glfw3.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+    EVENT_IDLE,
+    EVENT_PENDING,   // Injected, not yet sampled by the game
+    EVENT_SAMPLED,   // Read by the input code
+    EVENT_SIMULATED, // Simulation tick that applied it has finished
+    EVENT_SUBMITTED, // Frame showing it has been handed to GL
+};
+
+typedef struct {
+    uint64_t inject, sample, sim, submit, present;
+} LatencySample;
+
+static struct {
+    int enabled;
+    int target;
+    atomic_int count;
+    atomic_int state;
+    atomic_int key;
+    atomic_uint id;
+    uint64_t inject_ns;
+    LatencySample current;
+    LatencySample* samples;
+    pthread_t thread;
+    atomic_int running;
+} lat;
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull) };
+    nanosleep(&ts, NULL);
+}
+
+// Background injector; one event in flight at a time, random gaps so injections land at every frame phase
+static void* latency_injector(void* arg) {
+    (void)arg;
+    unsigned int seed = (unsigned int)time_now_ns();
+    int flip = 0;
+
+    while (atomic_load(&lat.running) && atomic_load(&lat.count) < lat.target) {
+        if (atomic_load(&lat.state) != EVENT_IDLE) {
+            sleep_ns(100000);
+            continue;
+        }
+        sleep_ns(5000000ull + (uint64_t)(rand_r(&seed) % 35000) * 1000ull);
+
+        // Alternate W / S so the paddle keeps visibly moving instead of pinning to the wall
+        atomic_store(&lat.key, flip ? GLFW_KEY_S : GLFW_KEY_W);
+        flip = !flip;
+        lat.inject_ns = time_now_ns();
+        atomic_fetch_add(&lat.id, 1);
+        atomic_store(&lat.state, EVENT_PENDING);
+    }
+    return NULL;
+}
+
+int latency_start(int samples) {
+    memset(&lat, 0, sizeof(lat));
+    lat.target = samples > 0 ? samples : 1;
+    lat.samples = calloc(lat.target, sizeof(LatencySample));
+    if (!lat.samples) return 0;
+
+    // Without the injector no event ever arrives and latency_done never turns true
+    atomic_store(&lat.running, 1);
+    if (pthread_create(&lat.thread, NULL, latency_injector, NULL) != 0) {
+        free(lat.samples);
+        lat.samples = NULL;
+        return 0;
+    }
+    lat.enabled = 1;
+    return 1;
+}
+
+void latency_stop(void) {
+    if (!lat.enabled) return;
+    atomic_store(&lat.running, 0);
+    pthread_join(lat.thread, NULL);
+    free(lat.samples);
+    lat.samples = NULL;
+    lat.enabled = 0;
+}
+
+int latency_enabled(void) {
+    return lat.enabled;
+}
+
+int latency_done(void) {
+    return lat.enabled && atomic_load(&lat.count) >= lat.target;
+}
+
+int latency_key_down(int key) {
+    if (!lat.enabled || atomic_load(&lat.state) != EVENT_PENDING) return 0;
+    if (atomic_load(&lat.key) != key) return 0;
+
+    lat.current.inject = lat.inject_ns;
+    lat.current.sample = time_now_ns();
+    atomic_store(&lat.state, EVENT_SAMPLED);
+    return 1;
+}
+
+unsigned latency_sampled_event(void) {
+    if (!lat.enabled || atomic_load(&lat.state) != EVENT_SAMPLED) return 0;
+    return atomic_load(&lat.id);
+}
+
+// Called from the sim thread
+void latency_mark_sim(unsigned event) {
+    if (!lat.enabled || event != atomic_load(&lat.id) || atomic_load(&lat.state) != EVENT_SAMPLED) return;
+    lat.current.sim = time_now_ns();
+    atomic_store(&lat.state, EVENT_SIMULATED);
+}
+
+void latency_mark_submit(unsigned event) {
+    if (!lat.enabled || event != atomic_load(&lat.id) || atomic_load(&lat.state) != EVENT_SIMULATED) return;
+    lat.current.submit = time_now_ns();
+    atomic_store(&lat.state, EVENT_SUBMITTED);
+}
+
+void latency_wait_present(void) {
+    if (!lat.enabled || atomic_load(&lat.state) != EVENT_SUBMITTED) return;
+
+    // The fence lands after the swap in the command stream, so it signals once the swap has executed
+    if (gl_ext.has_sync) {
+        GLExtSync fence = gl_ext.fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        gl_ext.client_wait_sync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        gl_ext.delete_sync(fence);
+    } else {
+        glFinish();
+    }
+    lat.current.present = time_now_ns();
+
+    int n = atomic_load(&lat.count);
+    if (n < lat.target) {
+        lat.samples[n] = lat.current;
+        atomic_store(&lat.count, n + 1);
+    }
+    atomic_store(&lat.state, EVENT_IDLE);
+}
+
+static void report_stage(FILE* out, const char* name, uint64_t* values, int n) {
+    qsort(values, n, sizeof(uint64_t), compare_u64);
+    fprintf(out, "  %-16s min %8.3f ms   median %8.3f ms   p99 %8.3f ms\n", name,
+        values[0] / 1e6, percentile(values, n, 50.0) / 1e6, percentile(values, n, 99.0) / 1e6);
+}
+
+void latency_report(FILE* out) {
+    int n = atomic_load(&lat.count);
+    if (n == 0) {
+        fprintf(out, "latency: no samples collected\n");
+        return;
+    }
+
+    uint64_t* values = malloc(n * sizeof(uint64_t));
+    if (!values) {
+        fprintf(out, "latency: %d samples, no memory to sort them\n", n);
+        return;
+    }
+    fprintf(out, "latency: %d samples, present wait via %s\n", n, gl_ext.has_sync ? "fence sync" : "glFinish");
+
+    for (int i = 0; i < n; i++) values[i] = lat.samples[i].sample - lat.samples[i].inject;
+    report_stage(out, "inject->sample", values, n);
+    for (int i = 0; i < n; i++) values[i] = lat.samples[i].sim - lat.samples[i].sample;
+    report_stage(out, "sample->sim", values, n);
+    for (int i = 0; i < n; i++) values[i] = lat.samples[i].submit - lat.samples[i].sim;
+    report_stage(out, "sim->submit", values, n);
+    for (int i = 0; i < n; i++) values[i] = lat.samples[i].present - lat.samples[i].submit;
+    report_stage(out, "submit->present", values, n);
+    for (int i = 0; i < n; i++) values[i] = lat.samples[i].present - lat.samples[i].inject;
+    report_stage(out, "input->present", values, n);
+
+    free(values);
+}
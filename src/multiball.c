@@ -0,0 +1,195 @@
+#include "multiball.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COURT_EDGE  1.1f    // Balls past this x score, like the single ball
+
+// xorshift32, so a seed fully determines the field like it does a match
+static uint32_t multiball_rand(MultiBall* field) {
+    uint32_t x = field->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return field->rng = x;
+}
+
+// Uniform in 0..1
+static float rand_unit(MultiBall* field) {
+    return (multiball_rand(field) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Back to the centre line at a random height and diagonal (Field, Ball)
+static void serve(MultiBall* field, int i) {
+    field->x[i] = 0.0f;
+    field->y[i] = (rand_unit(field) - 0.5f) * 1.6f;
+    field->vx[i] = multiball_rand(field) % 2 ? 0.01f : -0.01f;
+    field->vy[i] = (multiball_rand(field) % 2 ? 1.0f : -1.0f) * (0.005f + 0.01f * rand_unit(field));
+}
+
+int multiball_init(MultiBall* field, int count, float radius, uint32_t seed) {
+    memset(field, 0, sizeof(*field));
+    if (count < 1) count = 1;
+    // Default size keeps the balls' total area near an eighth of the court
+    if (radius <= 0.0f) radius = fminf(0.03f, fmaxf(0.004f, 0.4f / sqrtf((float)count)));
+
+    field->count = count;
+    field->radius = radius;
+    field->rng = seed ? seed : 1;
+    field->cell_size = radius * 2.0f;
+    field->grid_cols = (int)ceilf(2.0f * COURT_EDGE / field->cell_size) + 1;
+    field->grid_rows = (int)ceilf(2.0f / field->cell_size) + 1;
+
+    field->x = malloc(count * sizeof(float));
+    field->y = malloc(count * sizeof(float));
+    field->vx = malloc(count * sizeof(float));
+    field->vy = malloc(count * sizeof(float));
+    field->cell_start = malloc(((size_t)field->grid_cols * field->grid_rows + 1) * sizeof(int));
+    field->cell_balls = malloc(count * sizeof(int));
+    field->ball_cell = malloc(count * sizeof(int));
+    if (!field->x || !field->y || !field->vx || !field->vy || !field->cell_start || !field->cell_balls || !field->ball_cell) {
+        multiball_free(field);
+        return 0;
+    }
+
+    // Scattered over the middle of the court instead of all starting on the centre line
+    for (int i = 0; i < count; i++) {
+        serve(field, i);
+        field->x[i] = (rand_unit(field) - 0.5f) * 1.6f;
+    }
+    return 1;
+}
+
+void multiball_free(MultiBall* field) {
+    free(field->x);
+    free(field->y);
+    free(field->vx);
+    free(field->vy);
+    free(field->cell_start);
+    free(field->cell_balls);
+    free(field->ball_cell);
+    memset(field, 0, sizeof(*field));
+}
+
+// Grid cell holding a point; points off the grid go to the nearest edge cell (Field, X, Y)
+static int cell_of(const MultiBall* field, float x, float y) {
+    int cx = (int)((x + COURT_EDGE) / field->cell_size);
+    int cy = (int)((y + 1.0f) / field->cell_size);
+    if (cx < 0) cx = 0;
+    if (cx >= field->grid_cols) cx = field->grid_cols - 1;
+    if (cy < 0) cy = 0;
+    if (cy >= field->grid_rows) cy = field->grid_rows - 1;
+    return cy * field->grid_cols + cx;
+}
+
+// Counting sort of the balls into cells
+static void build_grid(MultiBall* field) {
+    int cells = field->grid_cols * field->grid_rows;
+    int* start = field->cell_start;
+    memset(start, 0, (cells + 1) * sizeof(int));
+
+    for (int i = 0; i < field->count; i++) {
+        int cell = cell_of(field, field->x[i], field->y[i]);
+        field->ball_cell[i] = cell;
+        start[cell + 1]++;
+    }
+    for (int c = 0; c < cells; c++) start[c + 1] += start[c];
+
+    // Scatter with start[] as a moving cursor, then shift it back to cell starts
+    for (int i = 0; i < field->count; i++) field->cell_balls[start[field->ball_cell[i]]++] = i;
+    memmove(start + 1, start, cells * sizeof(int));
+    start[0] = 0;
+}
+
+// Equal-mass elastic bounce between two balls if they overlap and approach (Field, Ball, Ball)
+static void collide(MultiBall* field, int i, int j) {
+    float dx = field->x[j] - field->x[i];
+    float dy = field->y[j] - field->y[i];
+    float d2 = dx * dx + dy * dy;
+    float reach = field->radius * 2.0f;
+    field->pair_tests++;
+    if (d2 >= reach * reach || d2 == 0.0f) return;
+
+    float d = sqrtf(d2);
+    float nx = dx / d, ny = dy / d;
+
+    // Equal masses: the normal components of the velocities swap
+    float closing = (field->vx[j] - field->vx[i]) * nx + (field->vy[j] - field->vy[i]) * ny;
+    if (closing < 0.0f) {
+        field->vx[i] += closing * nx;
+        field->vy[i] += closing * ny;
+        field->vx[j] -= closing * nx;
+        field->vy[j] -= closing * ny;
+        field->contacts++;
+    }
+
+    // Push apart so the pair doesn't stay stuck together
+    float push = (reach - d) * 0.5f;
+    field->x[i] -= nx * push;
+    field->y[i] -= ny * push;
+    field->x[j] += nx * push;
+    field->y[j] += ny * push;
+}
+
+void multiball_step(MultiBall* field, GameState* court, unsigned buttons) {
+    game_move_paddles(court, buttons);
+
+    const float r = field->radius;
+    float* x = field->x;
+    float* y = field->y;
+    float* vx = field->vx;
+    float* vy = field->vy;
+
+    /* Move, bounce off Top / Bottom */
+    for (int i = 0; i < field->count; i++) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+        if ((y[i] + r >= 1.0f && vy[i] > 0.0f) || (y[i] - r <= -1.0f && vy[i] < 0.0f)) vy[i] = -vy[i];
+    }
+
+    /* Paddles and scoring; the bounce is the single-ball one, on a copy of the ball */
+    for (int i = 0; i < field->count; i++) {
+        if (x[i] < -COURT_EDGE) {
+            court->right_points++;
+            serve(field, i);
+            continue;
+        }
+        if (x[i] > COURT_EDGE) {
+            court->left_points++;
+            serve(field, i);
+            continue;
+        }
+        int left = x[i] < 0.0f;
+        const Paddle* paddle = left ? &court->left : &court->right;
+        if (left ? x[i] - r > paddle->x + paddle->w : x[i] + r < paddle->x) continue;
+
+        Ball ball = { x[i], y[i], r, vx[i], vy[i] };
+        game_bounce_paddle(&ball, paddle, left);
+        x[i] = ball.x;
+        vx[i] = ball.vx;
+        vy[i] = ball.vy;
+    }
+
+    /* Ball against ball: rest of its own cell, then the four neighbours ahead, so each pair is seen once.
+       Walking the sorted balls rather than the cells skips the (mostly empty) grid. */
+    build_grid(field);
+    static const int ahead[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+    for (int a = 0; a < field->count; a++) {
+        int i = field->cell_balls[a];
+        int cell = field->ball_cell[i];
+        int cx = cell % field->grid_cols, cy = cell / field->grid_cols;
+        for (int b = a + 1; b < field->cell_start[cell + 1]; b++) collide(field, i, field->cell_balls[b]);
+
+        for (int n = 0; n < 4; n++) {
+            int nx = cx + ahead[n][0], ny = cy + ahead[n][1];
+            if (nx < 0 || nx >= field->grid_cols || ny >= field->grid_rows) continue;
+            int other = ny * field->grid_cols + nx;
+            for (int b = field->cell_start[other]; b < field->cell_start[other + 1]; b++) {
+                collide(field, i, field->cell_balls[b]);
+            }
+        }
+    }
+
+    court->tick++;
+}
@@ -0,0 +1,148 @@
+#include "particles.h"
+
+#include <math.h>
+#include <string.h>
+
+#define PARTICLE_GRAVITY 1.5f    // Court units per second squared, downwards
+#define PARTICLE_DRAG    2.0f    // Fraction of speed lost per second (linearised per frame)
+#define TWO_PI           6.28318531f
+
+/* Four floats at a time: SSE2 on x86-64, NEON on ARM, plain C elsewhere */
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128 Vec4;
+#define vec4_load(p)     _mm_load_ps(p)
+#define vec4_store(p, v) _mm_store_ps(p, v)
+#define vec4_set(s)      _mm_set1_ps(s)
+#define vec4_add(a, b)   _mm_add_ps(a, b)
+#define vec4_sub(a, b)   _mm_sub_ps(a, b)
+#define vec4_mul(a, b)   _mm_mul_ps(a, b)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+typedef float32x4_t Vec4;
+#define vec4_load(p)     vld1q_f32(p)
+#define vec4_store(p, v) vst1q_f32(p, v)
+#define vec4_set(s)      vdupq_n_f32(s)
+#define vec4_add(a, b)   vaddq_f32(a, b)
+#define vec4_sub(a, b)   vsubq_f32(a, b)
+#define vec4_mul(a, b)   vmulq_f32(a, b)
+#else
+typedef struct {
+    float v[4];
+} Vec4;
+
+static inline Vec4 vec4_load(const float* p) { Vec4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+static inline void vec4_store(float* p, Vec4 a) { memcpy(p, a.v, sizeof(a.v)); }
+static inline Vec4 vec4_set(float s) { return (Vec4){ { s, s, s, s } }; }
+static inline Vec4 vec4_add(Vec4 a, Vec4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+static inline Vec4 vec4_sub(Vec4 a, Vec4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+static inline Vec4 vec4_mul(Vec4 a, Vec4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+#endif
+
+// xorshift32, like the game's serves
+static uint32_t particle_rand(ParticlePool* pool) {
+    uint32_t x = pool->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return pool->rng = x;
+}
+
+// Uniform in lo..hi
+static float rand_range(ParticlePool* pool, float lo, float hi) {
+    return lo + (hi - lo) * ((particle_rand(pool) >> 8) * (1.0f / 16777216.0f));
+}
+
+static uint32_t pack_color(float r, float g, float b) {
+    return (uint32_t)(r * 255.0f) | (uint32_t)(g * 255.0f) << 8 | (uint32_t)(b * 255.0f) << 16;
+}
+
+void particles_init(ParticlePool* pool, uint32_t seed) {
+    /* The 4-wide passes run up to 3 lanes past count; zeroing once keeps those lanes
+       initialised (and finite) even for a pool that isn't static. Compaction only ever
+       leaves old particles behind, so they stay that way */
+    memset(pool, 0, sizeof(*pool));
+    pool->rng = seed ? seed : 1;
+}
+
+// How many of a burst the caps allow; past half full the burst shrinks with the free space (Pool, Requested)
+static int admit(ParticlePool* pool, int requested) {
+    int granted = requested;
+    int free_slots = PARTICLE_CAPACITY - pool->count;
+    if (pool->count > PARTICLE_CAPACITY / 2) granted = requested * free_slots / (PARTICLE_CAPACITY / 2);
+
+    int budget = PARTICLE_FRAME_BUDGET - pool->emitted;
+    if (granted > budget) granted = budget;
+    if (granted > free_slots) granted = free_slots;
+    if (granted < 0) granted = 0;
+
+    pool->trimmed += requested - granted;
+    pool->emitted += granted;
+    return granted;
+}
+
+// Append one particle; admit() has made room (Pool, X, Y, Angle, Speed, Life, Packed colour)
+static void spawn(ParticlePool* pool, float x, float y, float angle, float speed, float life, uint32_t color) {
+    int i = pool->count++;
+    pool->x[i] = x;
+    pool->y[i] = y;
+    pool->vx[i] = cosf(angle) * speed;
+    pool->vy[i] = sinf(angle) * speed;
+    pool->life[i] = life;
+    pool->fade[i] = 1.0f / life;
+    pool->color[i] = color;
+}
+
+int particles_sparks(ParticlePool* pool, float x, float y, float dx, float dy, int count, float r, float g, float b) {
+    int n = admit(pool, count);
+    float heading = atan2f(dy, dx);
+    uint32_t color = pack_color(r, g, b);
+    for (int i = 0; i < n; i++) {
+        spawn(pool, x, y, heading + rand_range(pool, -0.6f, 0.6f), rand_range(pool, 0.4f, 1.2f), rand_range(pool, 0.25f, 0.5f), color);
+    }
+    return n;
+}
+
+int particles_burst(ParticlePool* pool, float x, float y, int count, float r, float g, float b) {
+    int n = admit(pool, count);
+    uint32_t color = pack_color(r, g, b);
+    for (int i = 0; i < n; i++) {
+        spawn(pool, x, y, rand_range(pool, 0.0f, TWO_PI), rand_range(pool, 0.3f, 0.9f), rand_range(pool, 0.5f, 0.9f), color);
+    }
+    return n;
+}
+
+void particles_update(ParticlePool* pool, float dt) {
+    pool->emitted = 0;
+    if (pool->count == 0) return;
+
+    /* Integrate 4 at a time; the tail past count is scratch, so no scalar remainder loop */
+    float drag = fmaxf(0.0f, 1.0f - PARTICLE_DRAG * dt);
+    Vec4 step = vec4_set(dt), keep = vec4_set(drag), fall = vec4_set(PARTICLE_GRAVITY * dt);
+    for (int i = 0; i < pool->count; i += 4) {
+        Vec4 vx = vec4_mul(vec4_load(&pool->vx[i]), keep);
+        Vec4 vy = vec4_mul(vec4_sub(vec4_load(&pool->vy[i]), fall), keep);
+        vec4_store(&pool->vx[i], vx);
+        vec4_store(&pool->vy[i], vy);
+        vec4_store(&pool->x[i], vec4_add(vec4_load(&pool->x[i]), vec4_mul(vx, step)));
+        vec4_store(&pool->y[i], vec4_add(vec4_load(&pool->y[i]), vec4_mul(vy, step)));
+        vec4_store(&pool->life[i], vec4_sub(vec4_load(&pool->life[i]), step));
+    }
+
+    /* Dead ones swap with the last live particle; draw order between particles doesn't show */
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --pool->count;
+        pool->x[i] = pool->x[last];
+        pool->y[i] = pool->y[last];
+        pool->vx[i] = pool->vx[last];
+        pool->vy[i] = pool->vy[last];
+        pool->life[i] = pool->life[last];
+        pool->fade[i] = pool->fade[last];
+        pool->color[i] = pool->color[last];
+    }
+}
@@ -0,0 +1,628 @@
+#include "png_decode.h"
+#include "decode_arena.h"
+#include "stb_image.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PNG_SSE2 1
+#endif
+
+#define FAST_BITS       10                  // Codes up to this long decode with one table lookup
+#define FAST_MASK       ((1 << FAST_BITS) - 1)
+#define MAX_DIMENSION   (1 << 24)
+#define MAX_PIXEL_BYTES (1u << 31)
+#define MAX_THREADS     64
+
+/* Inflate */
+
+typedef struct {
+    uint16_t fast[1 << FAST_BITS];          // (length << 9) | symbol, 0 for longer codes
+    uint16_t first_code[17];
+    uint16_t first_symbol[17];
+    uint32_t max_code[18];                  // First code past each length, left-aligned to 16 bits
+    uint16_t symbols[288];                  // Sorted by code
+} Huffman;
+
+typedef struct {
+    const unsigned char* in;
+    const unsigned char* in_end;
+    uint64_t bits;                          // Next bits of the stream, lowest first
+    int count;                              // How many of them are valid
+    int padding;                            // Zero bytes fed in past the end of the input
+
+    unsigned char* out_start;
+    unsigned char* out;
+    unsigned char* out_end;
+} Inflate;
+
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Reverse the low n bits (Value, Bit count)
+static unsigned reverse_bits(unsigned v, int n) {
+    unsigned r = 0;
+    for (int i = 0; i < n; i++, v >>= 1) r = (r << 1) | (v & 1);
+    return r;
+}
+
+// Canonical Huffman table from code lengths; 0 if they over-subscribe the code space (Table, Lengths, Symbol count)
+static int huffman_build(Huffman* h, const uint8_t* lengths, int n) {
+    int counts[16] = { 0 };
+    uint16_t next_code[16];
+    for (int i = 0; i < n; i++) counts[lengths[i]]++;
+    counts[0] = 0;
+
+    memset(h->fast, 0, sizeof(h->fast));
+    unsigned code = 0, symbol = 0;
+    for (int len = 1; len < 16; len++) {
+        next_code[len] = (uint16_t)code;
+        h->first_code[len] = (uint16_t)code;
+        h->first_symbol[len] = (uint16_t)symbol;
+        code += counts[len];
+        if (counts[len] && code - 1 >= (1u << len)) return 0;
+        h->max_code[len] = code << (16 - len);
+        code <<= 1;
+        symbol += counts[len];
+    }
+    h->max_code[16] = 0x10000;
+
+    for (int i = 0; i < n; i++) {
+        int len = lengths[i];
+        if (!len) continue;
+        h->symbols[next_code[len] - h->first_code[len] + h->first_symbol[len]] = (uint16_t)i;
+        if (len <= FAST_BITS) {
+            // Streams store codes bit-reversed, so every fast slot ending in this code decodes it
+            for (unsigned j = reverse_bits(next_code[len], len); j < (1u << FAST_BITS); j += 1u << len) {
+                h->fast[j] = (uint16_t)(len << 9 | i);
+            }
+        }
+        next_code[len]++;
+    }
+    return 1;
+}
+
+// Top the bit buffer up to at least 57 bits; past the end it reads zeros and counts them
+static inline void refill(Inflate* z) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (z->in_end - z->in >= 8) {
+        uint64_t word;
+        memcpy(&word, z->in, 8);
+        z->bits |= word << z->count;
+        z->in += (63 - z->count) >> 3;
+        z->count |= 56;
+        return;
+    }
+#endif
+    while (z->count <= 56) {
+        uint64_t byte = 0;
+        if (z->in < z->in_end) {
+            byte = *z->in++;
+        } else {
+            z->padding++;
+        }
+        z->bits |= byte << z->count;
+        z->count += 8;
+    }
+}
+
+static inline unsigned take_bits(Inflate* z, int n) {
+    unsigned v = (unsigned)(z->bits & ((1ull << n) - 1));
+    z->bits >>= n;
+    z->count -= n;
+    return v;
+}
+
+// Codes longer than FAST_BITS, found by their left-aligned value
+static int decode_slow(Inflate* z, const Huffman* h) {
+    unsigned k = reverse_bits((unsigned)(z->bits & 0xffff), 16);
+    int len = FAST_BITS + 1;
+    while (k >= h->max_code[len]) len++;
+    if (len >= 16) return -1;
+    int index = (k >> (16 - len)) - h->first_code[len] + h->first_symbol[len];
+    if (index >= 288) return -1;
+    z->bits >>= len;
+    z->count -= len;
+    return h->symbols[index];
+}
+
+// Next symbol; the buffer must hold at least 15 bits
+static inline int decode_symbol(Inflate* z, const Huffman* h) {
+    unsigned entry = h->fast[z->bits & FAST_MASK];
+    if (!entry) return decode_slow(z, h);
+    int len = entry >> 9;
+    z->bits >>= len;
+    z->count -= len;
+    return entry & 511;
+}
+
+// Symbols of one compressed block up to its end code (Stream, Literal / length table, Distance table)
+static int inflate_codes(Inflate* z, const Huffman* lit, const Huffman* dist) {
+    unsigned char* out = z->out;
+    for (;;) {
+        refill(z);
+        if (z->padding > 8) return 0;
+        int symbol = decode_symbol(z, lit);
+
+        /* Runs of literals, refilling only once the buffer can't hold another code */
+        while ((unsigned)symbol < 256) {
+            if (out == z->out_end) return 0;
+            *out++ = (unsigned char)symbol;
+            if (z->count < 15) {
+                refill(z);
+                if (z->padding > 8) return 0;
+            }
+            symbol = decode_symbol(z, lit);
+        }
+        if (symbol < 0) return 0;
+        if (symbol == 256) break;
+
+        /* A length + distance pair takes at most 15 + 5 + 15 + 13 bits */
+        if (z->count < 48) refill(z);
+        symbol -= 257;
+        if (symbol >= 29) return 0;
+        int length = length_base[symbol] + take_bits(z, length_extra[symbol]);
+        int code = decode_symbol(z, dist);
+        if (code < 0 || code >= 30) return 0;
+        size_t distance = dist_base[code] + take_bits(z, dist_extra[code]);
+        if (distance > (size_t)(out - z->out_start) || length > z->out_end - out) return 0;
+
+        /* Far enough back, 8 bytes at a time may overshoot the match but never its source */
+        const unsigned char* from = out - distance;
+        if (distance >= 8 && z->out_end - out >= length + 8) {
+            for (int i = 0; i < length; i += 8) memcpy(out + i, from + i, 8);
+        } else if (distance == 1) {
+            memset(out, *from, length);
+        } else {
+            for (int i = 0; i < length; i++) out[i] = from[i];
+        }
+        out += length;
+    }
+    z->out = out;
+    return 1;
+}
+
+// Uncompressed block: hand back the buffered whole bytes, then copy
+static int inflate_stored(Inflate* z) {
+    take_bits(z, z->count & 7);
+    int buffered = (z->count >> 3) - z->padding;
+    if (buffered < 0) return 0;
+    z->in -= buffered;
+    z->bits = 0;
+    z->count = 0;
+    z->padding = 0;
+
+    if (z->in_end - z->in < 4) return 0;
+    unsigned length = z->in[0] | z->in[1] << 8;
+    unsigned check = z->in[2] | z->in[3] << 8;
+    z->in += 4;
+    if ((length ^ 0xffff) != check || length > (size_t)(z->in_end - z->in) || length > (size_t)(z->out_end - z->out)) return 0;
+    memcpy(z->out, z->in, length);
+    z->in += length;
+    z->out += length;
+    return 1;
+}
+
+// Read the code lengths of a dynamic block and build its two tables
+static int read_dynamic_tables(Inflate* z, Huffman* lit, Huffman* dist) {
+    static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    refill(z);
+    int lit_count = take_bits(z, 5) + 257;
+    int dist_count = take_bits(z, 5) + 1;
+    int length_codes = take_bits(z, 4) + 4;
+    if (lit_count > 286 || dist_count > 30) return 0;
+
+    uint8_t code_lengths[19] = { 0 };
+    for (int i = 0; i < length_codes; i++) {
+        refill(z);
+        code_lengths[order[i]] = (uint8_t)take_bits(z, 3);
+    }
+    Huffman* lengths_table = dist;   // Scratch until the distance table is built
+    if (!huffman_build(lengths_table, code_lengths, 19)) return 0;
+
+    uint8_t lengths[286 + 30];
+    int total = lit_count + dist_count, n = 0;
+    while (n < total) {
+        refill(z);
+        if (z->padding > 8) return 0;
+        int symbol = decode_symbol(z, lengths_table);
+        if (symbol < 0 || symbol >= 19) return 0;
+        if (symbol < 16) {
+            lengths[n++] = (uint8_t)symbol;
+            continue;
+        }
+        int repeat;
+        uint8_t fill = 0;
+        if (symbol == 16) {
+            if (n == 0) return 0;
+            repeat = 3 + take_bits(z, 2);
+            fill = lengths[n - 1];
+        } else if (symbol == 17) {
+            repeat = 3 + take_bits(z, 3);
+        } else {
+            repeat = 11 + take_bits(z, 7);
+        }
+        if (repeat > total - n) return 0;
+        memset(lengths + n, fill, repeat);
+        n += repeat;
+    }
+    if (lengths[256] == 0) return 0;
+    return huffman_build(lit, lengths, lit_count) && huffman_build(dist, lengths + lit_count, dist_count);
+}
+
+// zlib stream into a buffer that must come out exactly full; the Adler-32 isn't checked, as in stb_image (Input, Size, Output, Size)
+static int inflate_exact(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size) {
+    if (in_size < 2 || (in[0] & 15) != 8 || (in[0] << 8 | in[1]) % 31 != 0 || (in[1] & 32)) return 0;
+
+    Inflate z = { 0 };
+    z.in = in + 2;
+    z.in_end = in + in_size;
+    z.out_start = z.out = out;
+    z.out_end = out + out_size;
+
+    Huffman lit, dist;
+    int final;
+    do {
+        refill(&z);
+        final = take_bits(&z, 1);
+        int type = take_bits(&z, 2);
+        if (type == 0) {
+            if (!inflate_stored(&z)) return 0;
+        } else if (type == 1) {
+            uint8_t lengths[288 + 30];
+            memset(lengths, 8, 144);
+            memset(lengths + 144, 9, 112);
+            memset(lengths + 256, 7, 24);
+            memset(lengths + 280, 8, 8);
+            memset(lengths + 288, 5, 30);
+            huffman_build(&lit, lengths, 288);
+            huffman_build(&dist, lengths + 288, 30);
+            if (!inflate_codes(&z, &lit, &dist)) return 0;
+        } else if (type == 2) {
+            if (!read_dynamic_tables(&z, &lit, &dist) || !inflate_codes(&z, &lit, &dist)) return 0;
+        } else {
+            return 0;
+        }
+    } while (!final);
+    return z.out == z.out_end;
+}
+
+/* Row filters: reconstruct dst from the filtered bytes in src and the row above */
+
+static void unfilter_scalar(int filter, unsigned char* dst, const unsigned char* src, const unsigned char* prior, int n, int bpp) {
+    switch (filter) {
+    case 0:
+        memcpy(dst, src, n);
+        break;
+    case 1:
+        memcpy(dst, src, bpp);
+        for (int i = bpp; i < n; i++) dst[i] = (unsigned char)(src[i] + dst[i - bpp]);
+        break;
+    case 2:
+        for (int i = 0; i < n; i++) dst[i] = (unsigned char)(src[i] + prior[i]);
+        break;
+    case 3:
+        for (int i = 0; i < bpp; i++) dst[i] = (unsigned char)(src[i] + (prior[i] >> 1));
+        for (int i = bpp; i < n; i++) dst[i] = (unsigned char)(src[i] + ((dst[i - bpp] + prior[i]) >> 1));
+        break;
+    case 4:
+        for (int i = 0; i < bpp; i++) dst[i] = (unsigned char)(src[i] + prior[i]);
+        for (int i = bpp; i < n; i++) {
+            int a = dst[i - bpp], b = prior[i], c = prior[i - bpp];
+            int pa = abs(b - c), pb = abs(a - c), pc = abs(a + b - 2 * c);
+            int predictor = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+            dst[i] = (unsigned char)(src[i] + predictor);
+        }
+        break;
+    }
+}
+
+#ifdef PNG_SSE2
+/* One pixel per step in the low lanes; Sub, Avg and Paeth each depend on the pixel to
+   the left, so the win is doing all of a pixel's channels at once */
+
+static inline __m128i load_pixel(const unsigned char* p, int bpp) {
+    int v = 0;
+    memcpy(&v, p, bpp);
+    return _mm_cvtsi32_si128(v);
+}
+
+static inline void store_pixel(unsigned char* p, __m128i v, int bpp) {
+    int x = _mm_cvtsi128_si32(v);
+    memcpy(p, &x, bpp);
+}
+
+static inline void unfilter_up_sse2(unsigned char* dst, const unsigned char* src, const unsigned char* prior, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(src + i)), _mm_loadu_si128((const __m128i*)(prior + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), sum);
+    }
+    for (; i < n; i++) dst[i] = (unsigned char)(src[i] + prior[i]);
+}
+
+// Inlined with a constant bpp of 3 or 4, so the pixel loads and stores become single moves
+static inline void unfilter_pixels_sse2(int filter, unsigned char* dst, const unsigned char* src, const unsigned char* prior, int n, int bpp) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    if (filter == 1) {
+        for (int i = 0; i < n; i += bpp) {
+            a = _mm_add_epi8(load_pixel(src + i, bpp), a);
+            store_pixel(dst + i, a, bpp);
+        }
+    } else if (filter == 3) {
+        const __m128i one = _mm_set1_epi8(1);
+        for (int i = 0; i < n; i += bpp) {
+            __m128i b = load_pixel(prior + i, bpp);
+            // _mm_avg_epu8 rounds up; take the carry back off where a + b is odd
+            __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(load_pixel(src + i, bpp), average);
+            store_pixel(dst + i, a, bpp);
+        }
+    } else {
+        /* Paeth in 16-bit lanes: pa = |b - c|, pb = |a - c|, pc = |a + b - 2c| */
+        __m128i c = zero;
+        for (int i = 0; i < n; i += bpp) {
+            __m128i b = _mm_unpacklo_epi8(load_pixel(prior + i, bpp), zero);
+            __m128i pa = _mm_sub_epi16(b, c);
+            __m128i pb = _mm_sub_epi16(a, c);
+            __m128i pc = _mm_add_epi16(pa, pb);
+            pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+            pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+            pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+            __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+            __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+            __m128i use_b = _mm_cmpeq_epi16(smallest, pb);
+            __m128i b_or_c = _mm_or_si128(_mm_and_si128(use_b, b), _mm_andnot_si128(use_b, c));
+            __m128i predictor = _mm_or_si128(_mm_and_si128(use_a, a), _mm_andnot_si128(use_a, b_or_c));
+
+            __m128i x = _mm_add_epi8(load_pixel(src + i, bpp), _mm_packus_epi16(predictor, predictor));
+            store_pixel(dst + i, x, bpp);
+            a = _mm_unpacklo_epi8(x, zero);
+            c = b;
+        }
+    }
+}
+#endif
+
+// One row, SIMD where it helps (Filter type, Output row, Filtered row, Previous output row, Row bytes, Bytes per pixel)
+static void unfilter_row(int filter, unsigned char* dst, const unsigned char* src, const unsigned char* prior, int n, int bpp) {
+#ifdef PNG_SSE2
+    if (filter == 2) {
+        unfilter_up_sse2(dst, src, prior, n);
+        return;
+    }
+    if (filter == 1 || filter == 3 || filter == 4) {
+        if (bpp == 4) {
+            unfilter_pixels_sse2(filter, dst, src, prior, n, 4);
+            return;
+        }
+        if (bpp == 3) {
+            unfilter_pixels_sse2(filter, dst, src, prior, n, 3);
+            return;
+        }
+    }
+#endif
+    unfilter_scalar(filter, dst, src, prior, n, bpp);
+}
+
+/* PNG container */
+
+typedef struct {
+    int width, height, color_type, channels;
+    int has_palette;
+    unsigned char palette[256 * 4];
+    const unsigned char* idat;              // The image data, when it's all in one chunk
+    size_t idat_size;
+    int idat_chunks;
+} PngInfo;
+
+static uint32_t read_be32(const unsigned char* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Walk the chunks; 0 for anything the fast path doesn't take (File, Size, Output)
+static int parse_chunks(const unsigned char* file, size_t size, PngInfo* png) {
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    if (size < 8 || memcmp(file, signature, 8) != 0) return 0;
+
+    memset(png, 0, sizeof(*png));
+    for (int i = 0; i < 256; i++) png->palette[i * 4 + 3] = 255;
+    const unsigned char* p = file + 8;
+    const unsigned char* end = file + size;
+    int seen_header = 0, seen_end = 0;
+
+    while (end - p >= 12) {
+        uint32_t length = read_be32(p);
+        const unsigned char* type = p + 4;
+        const unsigned char* data = p + 8;
+        if (length > (size_t)(end - data) - 4) return 0;
+        p = data + length + 4;                          // Past the CRC, which isn't checked (nor is it by stb_image)
+
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) return 0;
+            png->width = (int)read_be32(data);
+            png->height = (int)read_be32(data + 4);
+            png->color_type = data[9];
+            if (data[8] != 8 || data[10] || data[11] || data[12]) return 0;   // 8-bit, deflate, adaptive, not interlaced
+            static const int channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+            if (png->color_type > 6 || !channels[png->color_type]) return 0;
+            png->channels = channels[png->color_type];
+            seen_header = 1;
+        } else if (!seen_header) {
+            return 0;
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            if (length % 3 || length > 256 * 3) return 0;
+            for (uint32_t i = 0; i < length / 3; i++) memcpy(&png->palette[i * 4], data + i * 3, 3);
+            png->has_palette = 1;
+        } else if (memcmp(type, "tRNS", 4) == 0) {
+            // Colour keys for grey / RGB go to stb_image; palette alpha is just a table
+            if (png->color_type != 3 || length > 256) return 0;
+            for (uint32_t i = 0; i < length; i++) png->palette[i * 4 + 3] = data[i];
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (!png->idat) png->idat = data;
+            png->idat_size += length;
+            png->idat_chunks++;
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            seen_end = 1;
+            break;
+        } else if (!(type[0] & 32)) {
+            return 0;                                    // Unknown critical chunk
+        }
+    }
+    if (!seen_end || !png->idat_chunks || (png->color_type == 3 && !png->has_palette)) return 0;
+    if (png->width <= 0 || png->height <= 0 || png->width > MAX_DIMENSION || png->height > MAX_DIMENSION) return 0;
+    return (uint64_t)png->width * png->height * 4 < MAX_PIXEL_BYTES;
+}
+
+// Image data split over several IDAT chunks, joined into one buffer (File, Info)
+static unsigned char* join_idat(const unsigned char* file, const PngInfo* png) {
+    unsigned char* joined = decode_malloc(png->idat_size);
+    if (!joined) return NULL;
+    const unsigned char* p = file + 8;
+    size_t at = 0;
+    while (at < png->idat_size) {
+        uint32_t length = read_be32(p);
+        if (memcmp(p + 4, "IDAT", 4) == 0) {
+            memcpy(joined + at, p + 8, length);
+            at += length;
+        }
+        p += 12 + length;
+    }
+    return joined;
+}
+
+// Widen one reconstructed row to RGBA (Output, Row, Width, Info)
+static void expand_row(unsigned char* out, const unsigned char* row, int width, const PngInfo* png) {
+    switch (png->color_type) {
+    case 0:
+        for (int x = 0; x < width; x++, out += 4) {
+            out[0] = out[1] = out[2] = row[x];
+            out[3] = 255;
+        }
+        break;
+    case 2:
+        for (int x = 0; x < width; x++, out += 4, row += 3) {
+            out[0] = row[0];
+            out[1] = row[1];
+            out[2] = row[2];
+            out[3] = 255;
+        }
+        break;
+    case 3:
+        for (int x = 0; x < width; x++, out += 4) memcpy(out, &png->palette[row[x] * 4], 4);
+        break;
+    case 4:
+        for (int x = 0; x < width; x++, out += 4, row += 2) {
+            out[0] = out[1] = out[2] = row[0];
+            out[3] = row[1];
+        }
+        break;
+    }
+}
+
+// Inflate, then unfilter row by row; RGBA rows go straight into the output (File, Info)
+static unsigned char* decode_fast(const unsigned char* file, const PngInfo* png) {
+    int width = png->width, height = png->height;
+    size_t stride = (size_t)width * png->channels;
+    size_t raw_size = (stride + 1) * height;
+
+    unsigned char* pixels = decode_malloc((size_t)width * height * 4);
+    unsigned char* raw = pixels ? decode_malloc(raw_size) : NULL;
+    unsigned char* joined = raw && png->idat_chunks > 1 ? join_idat(file, png) : NULL;
+    const unsigned char* idat = png->idat_chunks > 1 ? joined : png->idat;
+    // Two rows to unfilter into when they still need widening, plus the zero row above the first
+    unsigned char* rows = idat ? decode_malloc(stride * 3) : NULL;
+
+    int ok = rows && inflate_exact(idat, png->idat_size, raw, raw_size);
+    if (ok) {
+        memset(rows, 0, stride * 3);
+        const unsigned char* prior = rows + stride * 2;
+        for (int y = 0; y < height && ok; y++) {
+            const unsigned char* src = raw + y * (stride + 1);
+            unsigned char* dst = png->channels == 4 ? pixels + y * stride : rows + (y & 1) * stride;
+            if (src[0] > 4) ok = 0;
+            else unfilter_row(src[0], dst, src + 1, prior, (int)stride, png->channels);
+            if (png->channels != 4) expand_row(pixels + (size_t)y * width * 4, dst, width, png);
+            prior = dst;
+        }
+    }
+
+    /* Scratch is done with. Inside a decode arena only rows, the newest block, gives
+       its space back here; joined and raw stay allocated until decode_arena_end */
+    decode_free(rows);
+    decode_free(joined);
+    decode_free(raw);
+    if (!ok) {
+        decode_free(pixels);
+        return NULL;
+    }
+    return pixels;
+}
+
+unsigned char* png_decode(const unsigned char* file, int size, int* width, int* height) {
+    PngInfo png;
+    if (size > 0 && parse_chunks(file, size, &png)) {
+        unsigned char* pixels = decode_fast(file, &png);
+        if (pixels) {
+            *width = png.width;
+            *height = png.height;
+            return pixels;
+        }
+    }
+    int channels;
+    return stbi_load_from_memory(file, size, width, height, &channels, 4);
+}
+
+/* Batches */
+
+typedef struct {
+    PngJob* jobs;
+    int count;
+    atomic_int next;
+} Batch;
+
+// Take the next undecoded image until there are none left
+static void* batch_worker(void* arg) {
+    Batch* batch = arg;
+    int i;
+    while ((i = atomic_fetch_add(&batch->next, 1)) < batch->count) {
+        PngJob* job = &batch->jobs[i];
+        job->pixels = job->file ? png_decode(job->file, job->size, &job->width, &job->height) : NULL;
+        if (!job->pixels) job->width = job->height = 0;
+    }
+    return NULL;
+}
+
+void png_decode_batch(PngJob* jobs, int count, int threads) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > count) threads = count;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (threads < 1) threads = 1;
+
+    Batch batch = { .jobs = jobs, .count = count };
+    atomic_init(&batch.next, 0);
+    pthread_t workers[MAX_THREADS];
+    int started = 0;
+    while (started < threads - 1 && pthread_create(&workers[started], NULL, batch_worker, &batch) == 0) started++;
+    batch_worker(&batch);
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+}
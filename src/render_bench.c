@@ -0,0 +1,168 @@
+#include "render_bench.h"
+#include "gl_ext.h"
+#include "utils.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_WARMUP        5
+#define BENCH_FRAMES        60
+#define BENCH_MIN_FRAMES    3       // Measured frames kept even when a case is slow
+#define BENCH_CASE_SECONDS  3.0     // Time after which a case stops early
+#define BENCH_MAX_COUNTS    16      // Longer --render-bench lists are rejected
+
+static const char* path_names[BENCH_PATH_COUNT] = { "immediate", "batched", "instanced" };
+static const char* workload_names[BENCH_WORKLOAD_COUNT] = { "rects", "glyphs" };
+
+typedef struct {
+    BenchCase what;
+    int frames;                                  // Measured so far
+    uint64_t cpu_ns[BENCH_FRAMES];
+    uint64_t gpu_ns[BENCH_FRAMES];
+    uint64_t frame_ns[BENCH_FRAMES];
+    unsigned draws;                              // Per frame, from the last measured frame
+} BenchResult;
+
+static struct {
+    BenchResult* results;
+    int count;
+    int current;
+    int warmup;                                  // Warm-up frames left in the current case
+    uint64_t case_start_ns;
+    uint64_t frame_start_ns;
+    uint64_t last_frame_start_ns;
+    uint64_t cpu_ns;
+    int gpu;                                     // 1 = timer queries
+    GLuint query;
+} bench;
+
+int render_bench_start(const char* counts, unsigned paths) {
+    int values[BENCH_MAX_COUNTS];
+    int value_count = 0;
+    if (counts) {
+        const char* p = counts;
+        while (*p) {
+            if (value_count == BENCH_MAX_COUNTS) return 0;
+            char* end;
+            long v = strtol(p, &end, 10);
+            if (end == p || v <= 0) return 0;
+            values[value_count++] = (int)v;
+            p = *end == ',' ? end + 1 : end;
+            if (*end && *end != ',') return 0;
+        }
+    } else {
+        for (int v = 1000; v <= 1000000; v *= 10) values[value_count++] = v;
+    }
+    if (value_count == 0) return 0;
+
+    bench.results = calloc((size_t)BENCH_PATH_COUNT * BENCH_WORKLOAD_COUNT * value_count, sizeof(BenchResult));
+    if (!bench.results) {
+        fprintf(stderr, "render_bench: out of memory for %d counts\n", value_count);
+        return 0;
+    }
+    bench.count = 0;
+    for (int w = 0; w < BENCH_WORKLOAD_COUNT; w++) {
+        for (int i = 0; i < value_count; i++) {
+            for (int p = 0; p < BENCH_PATH_COUNT; p++) {
+                if (!(paths & (1u << p))) continue;
+                bench.results[bench.count++].what = (BenchCase){ (BenchPath)p, (BenchWorkload)w, values[i] };
+            }
+        }
+    }
+    bench.current = 0;
+    bench.warmup = BENCH_WARMUP;
+    bench.case_start_ns = 0;
+    bench.last_frame_start_ns = 0;
+
+    bench.gpu = gl_ext.has_timer_query;
+    if (bench.gpu) gl_ext.gen_queries(1, &bench.query);
+    for (int p = 0; p < BENCH_PATH_COUNT; p++) {
+        if (!(paths & (1u << p))) fprintf(stderr, "render_bench: %s path unavailable; skipping it\n", path_names[p]);
+    }
+    return 1;
+}
+
+int render_bench_case(BenchCase* out) {
+    if (bench.current >= bench.count) return 0;
+    *out = bench.results[bench.current].what;
+    return 1;
+}
+
+void render_bench_frame_begin(void) {
+    uint64_t now = time_now_ns();
+    if (bench.case_start_ns == 0) bench.case_start_ns = now;
+    bench.last_frame_start_ns = bench.frame_start_ns;
+    bench.frame_start_ns = now;
+    if (bench.gpu) gl_ext.begin_query(GL_TIME_ELAPSED, bench.query);
+}
+
+void render_bench_submitted(unsigned draws) {
+    if (bench.gpu) gl_ext.end_query(GL_TIME_ELAPSED);
+    bench.cpu_ns = time_now_ns() - bench.frame_start_ns;
+    bench.results[bench.current].draws = draws;
+}
+
+void render_bench_frame_end(void) {
+    BenchResult* result = &bench.results[bench.current];
+
+    // Waiting on the result stalls, but the stall lands in the frame time it belongs to anyway
+    unsigned long long gpu_ns = 0;
+    if (bench.gpu) gl_ext.get_query_objectui64v(bench.query, GL_QUERY_RESULT, &gpu_ns);
+
+    /* Frame time needs the previous frame of the same case, so the last warm-up frame only starts the clock */
+    if (bench.warmup > 0) {
+        bench.warmup--;
+    } else {
+        int i = result->frames++;
+        result->cpu_ns[i] = bench.cpu_ns;
+        result->gpu_ns[i] = gpu_ns;
+        result->frame_ns[i] = 0;
+        if (i > 0) result->frame_ns[i - 1] = bench.frame_start_ns - bench.last_frame_start_ns;
+    }
+
+    uint64_t elapsed = time_now_ns() - bench.case_start_ns;
+    int slow = elapsed > BENCH_CASE_SECONDS * 1e9;
+    if (result->frames == BENCH_FRAMES || (slow && result->frames > BENCH_MIN_FRAMES)) {
+        result->frames--;   // The last frame has no successor to close its frame time
+        fprintf(stderr, "render_bench: %s %s x%d done (%d frames)\n", path_names[result->what.path],
+            workload_names[result->what.workload], result->what.count, result->frames);
+        bench.current++;
+        bench.warmup = slow ? 1 : BENCH_WARMUP;
+        bench.case_start_ns = 0;
+    } else if (slow && bench.warmup > 1) {
+        bench.warmup = 1;
+    }
+}
+
+// Median and p95 of one column, in ms (Output, Values, Count)
+static void report_column(FILE* out, uint64_t* values, int n) {
+    qsort(values, n, sizeof(uint64_t), compare_u64);
+    fprintf(out, " %9.3f %9.3f", percentile(values, n, 50.0) / 1e6, percentile(values, n, 95.0) / 1e6);
+}
+
+void render_bench_report(FILE* out) {
+    fprintf(out, "render_bench: %s, GPU time via %s\n", (const char*)glGetString(GL_RENDERER),
+        bench.gpu ? "timer queries" : "(none; timer queries unsupported)");
+    fprintf(out, "%-10s %-7s %8s %6s | %-19s | %-19s | %-19s | %s\n", "path", "items", "count", "frames",
+        "cpu submit med/p95", "gpu med/p95", "frame med/p95", "draws");
+    for (int i = 0; i < bench.count; i++) {
+        BenchResult* result = &bench.results[i];
+        if (result->frames <= 0) continue;
+        fprintf(out, "%-10s %-7s %8d %6d |", path_names[result->what.path], workload_names[result->what.workload],
+            result->what.count, result->frames);
+        report_column(out, result->cpu_ns, result->frames);
+        fprintf(out, " |");
+        if (bench.gpu) report_column(out, result->gpu_ns, result->frames);
+        else fprintf(out, " %9s %9s", "-", "-");
+        fprintf(out, " |");
+        report_column(out, result->frame_ns, result->frames);
+        fprintf(out, " | %u\n", result->draws);
+    }
+}
+
+void render_bench_stop(void) {
+    if (bench.gpu) gl_ext.delete_queries(1, &bench.query);
+    free(bench.results);
+    memset(&bench, 0, sizeof(bench));
+}
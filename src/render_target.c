@@ -0,0 +1,133 @@
+#include "render_target.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "utils.h"
+
+#include <stdio.h>
+
+RenderTarget render_target;
+
+static GLuint framebuffer;
+static GLuint color_texture;
+
+int render_target_init(int width, int height, int window_width, int window_height) {
+    render_target.width = width;
+    render_target.height = height;
+    render_target.offscreen = 0;
+    render_target.scale = 1.0f;
+    render_target.scaled_width = width;
+    render_target.scaled_height = height;
+
+    if (gl_ext.has_fbo) {
+        glGenTextures(1, &color_texture);
+        gls_bind_texture(color_texture);
+        // No alpha channel: the present quad must come out opaque whatever blending left in the target
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        gl_ext.gen_framebuffers(1, &framebuffer);
+        gl_ext.bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
+        gl_ext.framebuffer_texture_2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_texture, 0);
+
+        if (gl_ext.check_framebuffer_status(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+            render_target.offscreen = 1;
+        } else {
+            fprintf(stderr, "Offscreen target %dx%d incomplete; drawing to the window directly\n", width, height);
+            gl_ext.bind_framebuffer(GL_FRAMEBUFFER, 0);
+            gl_ext.delete_framebuffers(1, &framebuffer);
+            glDeleteTextures(1, &color_texture);
+            framebuffer = color_texture = 0;
+            gls_invalidate();
+        }
+    }
+
+    render_target_resize(window_width, window_height);
+    return render_target.offscreen;
+}
+
+void render_target_shutdown(void) {
+    if (!render_target.offscreen) return;
+    gl_ext.bind_framebuffer(GL_FRAMEBUFFER, 0);
+    gl_ext.delete_framebuffers(1, &framebuffer);
+    glDeleteTextures(1, &color_texture);
+    render_target.offscreen = 0;
+}
+
+void render_target_resize(int window_width, int window_height) {
+    render_target.window_width = window_width;
+    render_target.window_height = window_height;
+
+    /* Largest rectangle with the internal aspect ratio, centred */
+    int w = window_width;
+    int h = (int)((long long)window_width * render_target.height / render_target.width);
+    if (h > window_height) {
+        h = window_height;
+        w = (int)((long long)window_height * render_target.width / render_target.height);
+    }
+    render_target.view_x = (window_width - w) / 2;
+    render_target.view_y = (window_height - h) / 2;
+    render_target.view_w = w;
+    render_target.view_h = h;
+
+    render_target_begin();
+}
+
+void render_target_set_scale(float scale) {
+    if (!render_target.offscreen) return;
+    scale = clamp(scale, 0.05f, 1.0f);
+    render_target.scale = scale;
+    render_target.scaled_width = (int)(render_target.width * scale + 0.5f);
+    render_target.scaled_height = (int)(render_target.height * scale + 0.5f);
+    if (render_target.scaled_width < 1) render_target.scaled_width = 1;
+    if (render_target.scaled_height < 1) render_target.scaled_height = 1;
+}
+
+void render_target_begin(void) {
+    if (render_target.offscreen) {
+        gl_ext.bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, render_target.scaled_width, render_target.scaled_height);
+        // Scissor too, so the per-frame glClear shrinks with the drawn region
+        glScissor(0, 0, render_target.scaled_width, render_target.scaled_height);
+        glEnable(GL_SCISSOR_TEST);
+    } else {
+        glViewport(render_target.view_x, render_target.view_y, render_target.view_w, render_target.view_h);
+    }
+}
+
+void render_target_present(void) {
+    if (!render_target.offscreen) return;
+
+    gl_ext.bind_framebuffer(GL_FRAMEBUFFER, 0);
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(0, 0, render_target.window_width, render_target.window_height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    /* One opaque quad; blending a full window would only cost fill */
+    if (render_target.view_w > 0 && render_target.view_h > 0) {
+        float u = (float)render_target.scaled_width / render_target.width;
+        float v = (float)render_target.scaled_height / render_target.height;
+        glViewport(render_target.view_x, render_target.view_y, render_target.view_w, render_target.view_h);
+        gls_texture_state(color_texture);
+        gls_disable(GL_BLEND);
+        gls_color4f(1.0f, 1.0f, 1.0f, 1.0f);
+        glBegin(GL_QUADS);
+            glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+            glTexCoord2f(u,    0.0f); glVertex2f( 1.0f, -1.0f);
+            glTexCoord2f(u,    v);    glVertex2f( 1.0f,  1.0f);
+            glTexCoord2f(0.0f, v);    glVertex2f(-1.0f,  1.0f);
+        glEnd();
+    }
+
+    render_target_begin();
+}
+
+void render_target_to_ndc(float pixel_x, float pixel_y, float* x, float* y) {
+    // Window pixels count down from the top, GL viewports up from the bottom
+    float from_bottom = render_target.window_height - pixel_y;
+    *x = render_target.view_w > 0 ? (pixel_x - render_target.view_x) / render_target.view_w * 2.0f - 1.0f : 0.0f;
+    *y = render_target.view_h > 0 ? (from_bottom - render_target.view_y) / render_target.view_h * 2.0f - 1.0f : 0.0f;
+}
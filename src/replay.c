@@ -0,0 +1,100 @@
+#include "replay.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void replay_init(Replay* replay, uint32_t seed, double tick_rate) {
+    memset(replay, 0, sizeof(*replay));
+    replay->seed = seed;
+    replay->players = 2;
+    replay->tick_rate = tick_rate;
+}
+
+void replay_free(Replay* replay) {
+    free(replay->events);
+    memset(replay, 0, sizeof(*replay));
+}
+
+void replay_record(Replay* replay, uint64_t tick, unsigned buttons) {
+    replay->end_tick = tick + 1;
+    if (replay->count > 0 && replay->events[replay->count - 1].buttons == buttons) return;
+    if (replay->count == 0 && buttons == 0) return;
+
+    if (replay->count == replay->capacity) {
+        uint32_t capacity = replay->capacity ? replay->capacity * 2 : 256;
+        ReplayEvent* events = realloc(replay->events, capacity * sizeof(ReplayEvent));
+        if (!events) return;
+        replay->events = events;
+        replay->capacity = capacity;
+    }
+    replay->events[replay->count++] = (ReplayEvent){ tick, buttons, 0 };
+}
+
+int replay_save(const Replay* replay, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return 0;
+
+    ReplayHeader header = {
+        REPLAY_MAGIC, REPLAY_VERSION, replay->seed, replay->count, replay->tick_rate, replay->end_tick, replay->players,
+        replay->fixed_point ? REPLAY_FIXED_POINT : 0
+    };
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(replay->events, sizeof(ReplayEvent), replay->count, file) == replay->count;
+    return fclose(file) == 0 && ok;
+}
+
+int replay_load(Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+
+    // Version 1 stops at players
+    ReplayHeader header = { .players = 2 };
+    size_t v1_size = offsetof(ReplayHeader, players);
+    if (fread(&header, v1_size, 1, file) != 1 || header.magic != REPLAY_MAGIC ||
+        header.version < 1 || header.version > REPLAY_VERSION || !(header.tick_rate > 0.0) ||
+        (header.version >= 2 && fread((char*)&header + v1_size, sizeof(header) - v1_size, 1, file) != 1)) {
+        fclose(file);
+        return 0;
+    }
+
+    // replay_simulate wants end_tick + 1 states in one block; refuse lengths that couldn't be sized or held
+    if (header.end_tick > REPLAY_MAX_TICKS || header.end_tick >= SIZE_MAX / sizeof(GameState)) {
+        fclose(file);
+        return 0;
+    }
+    replay->events = malloc((header.event_count ? header.event_count : 1) * sizeof(ReplayEvent));
+    if (!replay->events || fread(replay->events, sizeof(ReplayEvent), header.event_count, file) != header.event_count) {
+        fclose(file);
+        replay_free(replay);
+        return 0;
+    }
+    fclose(file);
+
+    replay->seed = header.seed;
+    replay->players = (int)header.players;
+    replay->fixed_point = (header.flags & REPLAY_FIXED_POINT) != 0;
+    replay->tick_rate = header.tick_rate;
+    replay->end_tick = header.end_tick;
+    replay->count = replay->capacity = header.event_count;
+    return 1;
+}
+
+unsigned replay_buttons(const Replay* replay, uint64_t tick, uint32_t* cursor) {
+    while (*cursor < replay->count && replay->events[*cursor].tick <= tick) (*cursor)++;
+    return *cursor > 0 ? replay->events[*cursor - 1].buttons : 0;
+}
+
+void replay_simulate(const Replay* replay, const Court* court, GameState* states) {
+    uint32_t cursor = 0;
+    game_init(&states[0], replay->seed);
+    game_set_players(&states[0], replay->players);
+    game_set_fixed_point(&states[0], replay->fixed_point);
+    states[0].court = court;
+    for (uint64_t tick = 0; tick < replay->end_tick; tick++) {
+        states[tick + 1] = states[tick];
+        game_step(&states[tick + 1], replay_buttons(replay, tick, &cursor));
+    }
+}
@@ -0,0 +1,81 @@
+#include "scene.h"
+
+#include "court.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static void add_rect(Scene* scene, float x, float y, float w, float h, float r, float g, float b, float a) {
+    if (scene->rect_count == SCENE_MAX_RECTS) return;
+    scene->rects[scene->rect_count++] = (SceneRect){ x, y, w, h, r, g, b, a };
+}
+
+#define CIRCLE_SLABS 6
+
+// Obstacles in grey; circles as a stack of slabs, wide enough to cover the circle at each slab's middle
+static void add_court(Scene* scene, const Court* court) {
+    for (int i = 0; i < court->rect_count; i++) {
+        const CourtRect* rect = &court->rects[i];
+        add_rect(scene, rect->x0, rect->y0, rect->x1 - rect->x0, rect->y1 - rect->y0, 0.55f, 0.55f, 0.55f, 1.0f);
+    }
+    for (int i = 0; i < court->circle_count; i++) {
+        const CourtCircle* circle = &court->circles[i];
+        float slab = circle->r * 2.0f / CIRCLE_SLABS;
+        for (int s = 0; s < CIRCLE_SLABS; s++) {
+            float y = -circle->r + (s + 0.5f) * slab;
+            float half = sqrtf(circle->r * circle->r - y * y);
+            add_rect(scene, circle->x - half, circle->y + y - slab * 0.5f, half * 2.0f, slab, 0.55f, 0.55f, 0.55f, 1.0f);
+        }
+    }
+}
+
+static void add_score(Scene* scene, int points, float x, float y) {
+    if (scene->text_count == SCENE_MAX_TEXTS) return;
+    SceneText* text = &scene->texts[scene->text_count++];
+    snprintf(text->text, sizeof(text->text), "%d", points);
+    text->x = x;
+    text->y = y;
+    text->size = SCENE_TEXT_SIZE;
+}
+
+void scene_game(Scene* scene, const GameState* state) {
+    scene->background[0] = scene->background[1] = scene->background[2] = 0.2f;
+    scene->rect_count = 0;
+    scene->text_count = 0;
+
+    if (state->court) add_court(scene, state->court);
+
+    // Paddles
+    add_rect(scene, state->left.x, state->left.y, state->left.w, state->left.h, 0.1f, 0.7f, 0.2f, 1.0f);
+    add_rect(scene, state->right.x, state->right.y, state->right.w, state->right.h, 0.1f, 0.2f, 0.7f, 1.0f);
+    if (state->players >= 3) add_rect(scene, state->bottom.x, state->bottom.y, state->bottom.w, state->bottom.h, 0.8f, 0.7f, 0.1f, 1.0f);
+    if (state->players >= 4) add_rect(scene, state->top.x, state->top.y, state->top.w, state->top.h, 0.6f, 0.2f, 0.7f, 1.0f);
+
+    // Ball (Square lol)
+    const Ball* ball = &state->ball;
+    add_rect(scene, ball->x - ball->radius, ball->y - ball->radius, ball->radius * 2, ball->radius * 2, 1.0f, 0.1f, 0.1f, 1.0f);
+
+    // Scores
+    add_score(scene, state->left_points, -0.5f, 0.8f);
+    add_score(scene, state->right_points, 0.5f, 0.8f);
+    if (state->players >= 3) add_score(scene, state->bottom_points, 0.0f, -0.55f);
+    if (state->players >= 4) add_score(scene, state->top_points, 0.0f, 0.75f);
+}
+
+void scene_fit(Scene* scene, float x, float y, float w, float h) {
+    float sx = w / 2.0f, sy = h / 2.0f;
+    float text_scale = sx < sy ? sx : sy;
+    for (int i = 0; i < scene->rect_count; i++) {
+        SceneRect* rect = &scene->rects[i];
+        rect->x = x + (rect->x + 1.0f) * sx;
+        rect->y = y + (rect->y + 1.0f) * sy;
+        rect->w *= sx;
+        rect->h *= sy;
+    }
+    for (int i = 0; i < scene->text_count; i++) {
+        SceneText* text = &scene->texts[i];
+        text->x = x + (text->x + 1.0f) * sx;
+        text->y = y + (text->y + 1.0f) * sy;
+        text->size *= text_scale;
+    }
+}
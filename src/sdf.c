@@ -0,0 +1,88 @@
+#include "sdf.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static const char font_chars[] =
+    " !\"#$%&'()*+,-./"
+    "0123456789:;<=>?"
+    "@ABCDEFGHIJKLMNO"
+    "PQRSTUVWXYZ[\\]^_"
+    "`abcdefghijklmno"
+    "pqrstuvwxyz{|}~";
+
+int font_index(uint32_t c) {
+    for (int i = 0; font_chars[i]; i++) {
+        if ((unsigned char)font_chars[i] == c) return i;
+    }
+    return -1;
+}
+
+int font_cell_uv(uint32_t c, float uv[4]) {
+    int index = font_index(c);
+    if (index == -1) return 0;
+    int col = index % FONT_COLS;
+    int row = index / FONT_COLS;
+
+    float cell_w = (float)FONT_CELL_W / (FONT_COLS * FONT_CELL_W);
+    float cell_h = (float)FONT_CELL_H / (FONT_ROWS * FONT_CELL_H);
+
+    float u0 = col * cell_w;
+    float v0 = (FONT_ROWS - 1 - row) * cell_h;
+    uv[0] = u0;
+    uv[1] = 1.0f - (v0 + cell_h);
+    uv[2] = u0 + cell_w;
+    uv[3] = 1.0f - v0;
+    return 1;
+}
+
+// White fill pixels; the dark outline around them is 1 px wide everywhere, so the field only needs the fill
+static int in_fill(const unsigned char* p) { return p[3] > 0 && p[0] > 128; }
+
+// Signed distance (source pixels, negative inside) from point (px, py) to the edge of a glyph's fill
+static float cell_distance(const unsigned char* rgba, int width, int cell_x, int cell_y, float px, float py) {
+    int sx = (int)px, sy = (int)py;
+    int self = in_fill(rgba + ((cell_y + sy) * width + cell_x + sx) * 4);
+    int radius = (int)(SDF_SPREAD / SDF_SCALE) + 1;
+    float best = (float)radius + 1.0f;
+
+    for (int qy = sy - radius; qy <= sy + radius; qy++) {
+        for (int qx = sx - radius; qx <= sx + radius; qx++) {
+            // Pixels past the cell edge count as empty so neighbours never bleed in
+            int outside_cell = qx < 0 || qy < 0 || qx >= FONT_CELL_W || qy >= FONT_CELL_H;
+            int other = outside_cell ? 0 : in_fill(rgba + ((cell_y + qy) * width + cell_x + qx) * 4);
+            if (other == self) continue;
+
+            float dx = fmaxf(fmaxf(qx - px, 0.0f), px - (qx + 1));
+            float dy = fmaxf(fmaxf(qy - py, 0.0f), py - (qy + 1));
+            float d = sqrtf(dx * dx + dy * dy);
+            if (d < best) best = d;
+        }
+    }
+    return self ? -best : best;
+}
+
+static unsigned char encode_distance(float d) {
+    float v = 0.5f - d * SDF_SCALE / (2.0f * SDF_SPREAD);
+    if (v < 0.0f) v = 0.0f;
+    if (v > 1.0f) v = 1.0f;
+    return (unsigned char)(v * 255.0f + 0.5f);
+}
+
+unsigned char* build_sdf_atlas(const unsigned char* rgba, int width, int height) {
+    int out_w = width * SDF_SCALE, out_h = height * SDF_SCALE;
+    unsigned char* sdf = malloc((size_t)out_w * out_h);
+    if (!sdf) return NULL;
+
+    for (int y = 0; y < out_h; y++) {
+        for (int x = 0; x < out_w; x++) {
+            // Texel centre in source pixels, relative to its glyph cell
+            float fx = (x + 0.5f) / SDF_SCALE, fy = (y + 0.5f) / SDF_SCALE;
+            int cell_x = (int)(fx / FONT_CELL_W) * FONT_CELL_W;
+            int cell_y = (int)(fy / FONT_CELL_H) * FONT_CELL_H;
+
+            sdf[(size_t)y * out_w + x] = encode_distance(cell_distance(rgba, width, cell_x, cell_y, fx - cell_x, fy - cell_y));
+        }
+    }
+    return sdf;
+}
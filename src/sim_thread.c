@@ -0,0 +1,111 @@
+#include "sim_thread.h"
+#include "frame_pacer.h"
+#include "latency.h"
+#include "utils.h"
+
+#define SNAPSHOT_FRESH 4u
+
+// Hand the back slot to the reader and take the old middle slot to write next
+static void snapshot_publish(SnapshotBuffer* buffer) {
+    unsigned old = atomic_exchange(&buffer->middle, buffer->back | SNAPSHOT_FRESH);
+    buffer->back = old & 3u;
+}
+
+// Swap in the newest snapshot if one was published; returns 1 when the front slot changed
+static int snapshot_acquire(SnapshotBuffer* buffer) {
+    if (!(atomic_load(&buffer->middle) & SNAPSHOT_FRESH)) return 0;
+    unsigned old = atomic_exchange(&buffer->middle, buffer->front);
+    buffer->front = old & 3u;
+    return 1;
+}
+
+static void* sim_thread_main(void* arg) {
+    Simulation* sim = arg;
+
+    FramePacer pacer;
+    frame_pacer_init(&pacer, sim->tick_rate, "sim");
+    pacer.late_latch = 0;
+
+    while (atomic_load(&sim->running)) {
+        frame_pacer_wait(&pacer);
+        if (atomic_load(&sim->paused)) continue;
+
+        // Event before buttons: sim_set_input stores them in the opposite order
+        unsigned event = atomic_exchange(&sim->input_event, 0);
+        unsigned buttons = atomic_load(&sim->held) | atomic_exchange(&sim->pressed, 0);
+
+        if (sim->record) replay_record(sim->record, sim->state.tick, buttons);
+        game_step(&sim->state, buttons);
+        sim->state.time_ns = time_now_ns();
+        if (event) {
+            sim->state.input_event = event;
+            latency_mark_sim(event);
+        }
+
+        sim->snapshots.slots[sim->snapshots.back] = sim->state;
+        snapshot_publish(&sim->snapshots);
+    }
+    frame_pacer_summary(&pacer);
+    return NULL;
+}
+
+int sim_start(Simulation* sim, double tick_rate, uint32_t seed, int players, int fixed_point, const Court* court, Replay* record) {
+    game_init(&sim->state, seed);
+    game_set_players(&sim->state, players);
+    game_set_fixed_point(&sim->state, fixed_point);
+    sim->state.court = court;
+    sim->state.time_ns = time_now_ns();
+    for (int i = 0; i < 3; i++) sim->snapshots.slots[i] = sim->state;
+    sim->snapshots.front = 0;
+    atomic_init(&sim->snapshots.middle, 1);
+    sim->snapshots.back = 2;
+    sim->prev = sim->latest = sim->state;
+
+    atomic_init(&sim->held, 0);
+    atomic_init(&sim->pressed, 0);
+    atomic_init(&sim->input_event, 0);
+    atomic_init(&sim->paused, 1);
+    atomic_init(&sim->running, 1);
+    sim->tick_rate = tick_rate;
+    sim->record = record;
+    if (pthread_create(&sim->thread, NULL, sim_thread_main, sim) != 0) {
+        atomic_store(&sim->running, 0);
+        return 0;
+    }
+    return 1;
+}
+
+void sim_stop(Simulation* sim) {
+    atomic_store(&sim->running, 0);
+    pthread_join(sim->thread, NULL);
+}
+
+void sim_set_paused(Simulation* sim, int paused) {
+    atomic_store(&sim->paused, paused);
+}
+
+void sim_set_input(Simulation* sim, unsigned buttons, unsigned event) {
+    atomic_store(&sim->held, buttons);
+    if (buttons) atomic_fetch_or(&sim->pressed, buttons);
+    if (event) atomic_store(&sim->input_event, event);
+}
+
+void sim_view(Simulation* sim, GameState* out) {
+    if (snapshot_acquire(&sim->snapshots)) {
+        sim->prev = sim->latest;
+        sim->latest = sim->snapshots.slots[sim->snapshots.front];
+    }
+
+    // Render one tick in the past so there is always a pair of ticks to blend between
+    uint64_t period = (uint64_t)(1e9 / sim->tick_rate);
+    uint64_t now = time_now_ns();
+    uint64_t view_time = now > period ? now - period : 0;
+
+    const GameState* a = &sim->prev;
+    const GameState* b = &sim->latest;
+    float t = 1.0f;
+    if (b->time_ns > a->time_ns && view_time < b->time_ns) {
+        t = view_time <= a->time_ns ? 0.0f : (float)(view_time - a->time_ns) / (float)(b->time_ns - a->time_ns);
+    }
+    game_lerp(out, a, b, t);
+}
@@ -0,0 +1,101 @@
+#include "soft_raster.h"
+#include "sdf.h"
+
+#include <math.h>
+#include <string.h>
+
+static unsigned char to_byte(float v) {
+    return (unsigned char)(v <= 0.0f ? 0 : v >= 1.0f ? 255 : v * 255.0f + 0.5f);
+}
+
+// First pixel whose centre is at or past an edge, in pixels (Edge)
+static int first_covered(float edge) {
+    return (int)ceilf(edge - 0.5f);
+}
+
+// Blend one pixel (Destination; Red, Green, Blue as bytes; Alpha 0..255)
+static void blend(unsigned char* dst, int r, int g, int b, int a) {
+    if (a >= 255) {
+        dst[0] = (unsigned char)r; dst[1] = (unsigned char)g; dst[2] = (unsigned char)b;
+        return;
+    }
+    dst[0] = (unsigned char)((r * a + dst[0] * (255 - a) + 127) / 255);
+    dst[1] = (unsigned char)((g * a + dst[1] * (255 - a) + 127) / 255);
+    dst[2] = (unsigned char)((b * a + dst[2] * (255 - a) + 127) / 255);
+}
+
+void soft_clear(SoftCanvas* canvas, float r, float g, float b) {
+    unsigned char px[4] = { to_byte(r), to_byte(g), to_byte(b), 255 };
+    size_t count = (size_t)canvas->width * canvas->height;
+    for (size_t i = 0; i < count; i++) memcpy(canvas->rgba + i * 4, px, 4);
+}
+
+void soft_rect(SoftCanvas* canvas, float x, float y, float w, float h, float r, float g, float b, float a) {
+    /* -1..1 to pixels, y flipped for top-down rows */
+    float sx = canvas->width * 0.5f, sy = canvas->height * 0.5f;
+    int x0 = first_covered((x + 1.0f) * sx);
+    int x1 = first_covered((x + w + 1.0f) * sx);
+    int y0 = first_covered((1.0f - (y + h)) * sy);
+    int y1 = first_covered((1.0f - y) * sy);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width) x1 = canvas->width;
+    if (y1 > canvas->height) y1 = canvas->height;
+
+    int rb = to_byte(r), gb = to_byte(g), bb = to_byte(b), ab = to_byte(a);
+    for (int py = y0; py < y1; py++) {
+        unsigned char* row = canvas->rgba + ((size_t)py * canvas->width + x0) * 4;
+        for (int px = x0; px < x1; px++, row += 4) blend(row, rb, gb, bb, ab);
+    }
+}
+
+// One glyph cell stretched over the square from (x, y) down to (x + size, y - size)
+static void soft_char(SoftCanvas* canvas, const SoftFont* font, int index, float x, float y, float size) {
+    int cell_w = font->width / FONT_COLS, cell_h = font->height / FONT_ROWS;
+    int cell_x = (index % FONT_COLS) * cell_w, cell_y = (index / FONT_COLS) * cell_h;
+
+    float sx = canvas->width * 0.5f, sy = canvas->height * 0.5f;
+    float left = (x + 1.0f) * sx, right = (x + size + 1.0f) * sx;
+    float top = (1.0f - y) * sy, bottom = (1.0f - (y - size)) * sy;
+    int x0 = first_covered(left), x1 = first_covered(right);
+    int y0 = first_covered(top), y1 = first_covered(bottom);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width) x1 = canvas->width;
+    if (y1 > canvas->height) y1 = canvas->height;
+
+    for (int py = y0; py < y1; py++) {
+        int v = (int)((py + 0.5f - top) / (bottom - top) * cell_h);
+        if (v < 0) v = 0;
+        if (v >= cell_h) v = cell_h - 1;
+        const unsigned char* src_row = font->rgba + ((size_t)(cell_y + v) * font->width + cell_x) * 4;
+        unsigned char* row = canvas->rgba + ((size_t)py * canvas->width + x0) * 4;
+        for (int px = x0; px < x1; px++, row += 4) {
+            int u = (int)((px + 0.5f - left) / (right - left) * cell_w);
+            if (u < 0) u = 0;
+            if (u >= cell_w) u = cell_w - 1;
+            const unsigned char* src = src_row + u * 4;
+            if (src[3]) blend(row, src[0], src[1], src[2], src[3]);
+        }
+    }
+}
+
+void soft_text(SoftCanvas* canvas, const SoftFont* font, const char* text, float x, float y, float size) {
+    for (; *text; text++, x += size) {
+        int index = font_index((unsigned char)*text);
+        if (index >= 0) soft_char(canvas, font, index, x, y, size);
+    }
+}
+
+void soft_draw_scene(SoftCanvas* canvas, const SoftFont* font, const Scene* scene) {
+    soft_clear(canvas, scene->background[0], scene->background[1], scene->background[2]);
+    for (int i = 0; i < scene->rect_count; i++) {
+        const SceneRect* rect = &scene->rects[i];
+        soft_rect(canvas, rect->x, rect->y, rect->w, rect->h, rect->r, rect->g, rect->b, rect->a);
+    }
+    for (int i = 0; i < scene->text_count; i++) {
+        const SceneText* text = &scene->texts[i];
+        float width = strlen(text->text) * text->size;
+        soft_text(canvas, font, text->text, text->x - width / 2.0f, text->y, text->size);
+    }
+}
@@ -0,0 +1,99 @@
+#include "startup.h"
+#include "utils.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#include <sys/time.h>
+#endif
+
+#define MAX_STAGES 32
+
+static struct {
+    int enabled;
+    uint64_t main_ns;            // Monotonic time at startup_begin
+    uint64_t before_main_ns;     // exec to main, 0 if unknown
+    const char* names[MAX_STAGES];
+    uint64_t times[MAX_STAGES];
+    int count;
+} boot;
+
+// How long the process ran before main (dynamic loading, static constructors); 0 if unknown
+static uint64_t time_before_main(void) {
+#if defined(__APPLE__)
+    struct kinfo_proc info;
+    size_t size = sizeof(info);
+    int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid() };
+    if (sysctl(mib, 4, &info, &size, NULL, 0) != 0) return 0;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    struct timeval start = info.kp_proc.p_starttime;
+    int64_t us = (int64_t)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_usec - start.tv_usec);
+    return us > 0 ? (uint64_t)us * 1000 : 0;
+#elif defined(__linux__)
+    // Field 22 of /proc/self/stat is the start time in clock ticks after boot
+    FILE* file = fopen("/proc/self/stat", "r");
+    if (!file) return 0;
+    char line[1024];
+    size_t length = fread(line, 1, sizeof(line) - 1, file);
+    fclose(file);
+    line[length] = '\0';
+    char* field = strrchr(line, ')');   // The command name may contain spaces
+    unsigned long long ticks = 0;
+    if (!field || sscanf(field + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &ticks) != 1) return 0;
+    long hz = sysconf(_SC_CLK_TCK);
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+    uint64_t start_ns = ticks * (1000000000ull / (uint64_t)hz);
+    return now_ns > start_ns ? now_ns - start_ns : 0;
+#else
+    return 0;
+#endif
+}
+
+void startup_begin(void) {
+    boot.main_ns = time_now_ns();
+    boot.before_main_ns = time_before_main();
+}
+
+void startup_enable(void) {
+    boot.enabled = 1;
+}
+
+int startup_enabled(void) {
+    return boot.enabled;
+}
+
+void startup_mark(const char* stage) {
+    if (!boot.enabled || boot.count == MAX_STAGES) return;
+    boot.names[boot.count] = stage;
+    boot.times[boot.count] = time_now_ns();
+    boot.count++;
+}
+
+void startup_report(FILE* out) {
+    uint64_t total = boot.before_main_ns + (boot.count ? boot.times[boot.count - 1] - boot.main_ns : 0);
+    fprintf(out, "startup: %.3f ms to the first interactive frame\n", total / 1e6);
+    fprintf(out, "  %-34s %10s %7s %10s\n", "stage", "ms", "share", "at ms");
+
+    uint64_t at = boot.before_main_ns;
+    if (boot.before_main_ns) {
+        fprintf(out, "  %-34s %10.3f %6.1f%% %10.3f\n", "exec -> main", boot.before_main_ns / 1e6,
+            100.0 * boot.before_main_ns / total, at / 1e6);
+    } else {
+        fprintf(out, "  %-34s %10s\n", "exec -> main", "unknown");
+    }
+    uint64_t previous = boot.main_ns;
+    for (int i = 0; i < boot.count; i++) {
+        uint64_t stage = boot.times[i] - previous;
+        at += stage;
+        fprintf(out, "  %-34s %10.3f %6.1f%% %10.3f\n", boot.names[i], stage / 1e6, total ? 100.0 * stage / total : 0.0, at / 1e6);
+        previous = boot.times[i];
+    }
+}
@@ -0,0 +1,235 @@
+#include "text.h"
+#include "decode_arena.h"
+#include "sdf.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "glyph_cache.h"
+#include "png_decode.h"
+#include "startup.h"
+#include "vertex_stream.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// stb_image allocates through the decode arena while one is active
+#define STBI_MALLOC(size)                 decode_malloc(size)
+#define STBI_REALLOC_SIZED(p, old, size)  decode_realloc(p, old, size)
+#define STBI_FREE(p)                      decode_free(p)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#define FONT_DECODE_BYTES (4 << 20)   // Cap for reading + decoding font.png; a 512 x 512 atlas fits with room to spare
+
+GLuint font_texture;
+static GLuint sdf_programs[2];   // Plain, outlined
+static int sdf_programs_built;
+
+/* One distance channel, two contours: the fill edge at 0.5 and the silhouette `outline`
+   further out. Luminance picks white fill vs. dark outline, alpha cuts the silhouette */
+static const char* sdf_fragment_format =
+    "uniform sampler2D atlas;\n"
+    "const float edge = %.4f;\n"
+    "void main() {\n"
+    "    float d = texture2D(atlas, gl_TexCoord[0].st).a;\n"
+    "    float w = max(fwidth(d) * 0.7, 0.001);\n"
+    "    float alpha = smoothstep(edge - w, edge + w, d);\n"
+    "    float fill = smoothstep(0.5 - w, 0.5 + w, d);\n"
+    "    gl_FragColor = vec4(gl_Color.rgb * fill, gl_Color.a * alpha);\n"
+    "}\n";
+
+// Compile the distance field shader for one silhouette contour; 0 without GLSL (Silhouette level)
+static GLuint build_sdf_program(float edge) {
+    char source[512];
+    snprintf(source, sizeof(source), sdf_fragment_format, edge);
+    GLuint program = gl_ext_build_program(NULL, source);
+    if (program) {
+        gls_use_program(program);
+        gl_ext.uniform1i(gl_ext.get_uniform_location(program, "atlas"), 0);
+        gls_use_program(0);
+    }
+    return program;
+}
+
+void upload_sdf_atlas(const unsigned char* sdf, int width, int height) {
+    // GL_INTENSITY repeats the one channel into rgb and alpha, which the no-GLSL alpha test path needs
+    glGenTextures(1, &font_texture);
+    gls_bind_texture(font_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_INTENSITY, width, height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, sdf);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    register_sdf_texture(font_texture, SDF_OUTLINE);
+}
+
+int load_font_pack(const AssetPack* pack) {
+    const AssetEntry* atlas = asset_pack_find(pack, "font.sdf", ASSET_L8);
+    if (!atlas || atlas->size < (uint64_t)atlas->width * atlas->height) return 0;
+
+    // GL reads the pixels straight out of the mapping
+    upload_sdf_atlas(asset_pack_data(pack, atlas), atlas->width, atlas->height);
+    if (startup_enabled()) glFinish();
+    startup_mark("load_font_pack: upload");
+
+    const AssetEntry* ttf = asset_pack_find(pack, "font.ttf", ASSET_RAW);
+    if (ttf) glyph_cache_init_memory(asset_pack_data(pack, ttf), (uint32_t)ttf->size);
+    startup_mark("load_font_pack: glyph cache");
+    return 1;
+}
+
+void register_sdf_texture(GLuint texture, float outline) {
+    // Smoothstep shader when GLSL is there, else a hard alpha test at the silhouette contour
+    if (!sdf_programs_built) {
+        sdf_programs_built = 1;
+        sdf_programs[0] = build_sdf_program(0.5f);
+        sdf_programs[1] = build_sdf_program(0.5f - SDF_OUTLINE);
+    }
+    GLuint program = sdf_programs[outline > 0.0f];
+    gls_register_texture(texture, program, program ? 0.0f : 0.5f - outline);
+}
+
+// Whole file into memory, from the decode arena when one is active; NULL on failure (Path, Output size)
+static unsigned char* read_file(const char* path, int* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* bytes = length > 0 ? decode_malloc(length) : NULL;
+    if (bytes && fread(bytes, 1, length, file) != (size_t)length) {
+        decode_free(bytes);
+        bytes = NULL;
+    }
+    fclose(file);
+    *size = (int)length;
+    return bytes;
+}
+
+void load_font_texture(const char* path) {
+    /* The file, the inflate buffers and the pixels share one capped arena, freed
+       in one go once the distance field is built; without it, decode on the heap */
+    DecodeArena arena;
+    int scoped = decode_arena_init(&arena, FONT_DECODE_BYTES);
+    if (scoped) decode_arena_begin(&arena);
+
+    /* Read and decode are separate steps so the startup report can tell disk from inflate */
+    int size = 0;
+    unsigned char* file = read_file(path, &size);
+    startup_mark("load_font_texture: read file");
+
+    int width, height;
+    unsigned char* data = file ? png_decode(file, size, &width, &height) : NULL;
+    decode_free(file);
+    if (!data) {
+        fprintf(stderr, "Could not load texture: %s\n", path);
+        exit(1);
+    }
+    startup_mark("load_font_texture: PNG decode");
+
+    unsigned char* sdf = build_sdf_atlas(data, width, height);
+    stbi_image_free(data);
+    if (!sdf) {
+        fprintf(stderr, "Out of memory building the font distance field\n");
+        exit(1);
+    }
+    if (scoped) {
+        decode_arena_end(&arena);
+        if (startup_enabled()) decode_arena_report(&arena, "load_font_texture", stdout);
+        decode_arena_release(&arena);
+    }
+    startup_mark("load_font_texture: distance field");
+    upload_sdf_atlas(sdf, width * SDF_SCALE, height * SDF_SCALE);
+    if (startup_enabled()) glFinish();   // Charge the upload to its own stage, not the first frame
+    startup_mark("load_font_texture: upload");
+    free(sdf);
+}
+
+// Emit one textured quad through the stream, or immediately (Corners, UVs, Texture)
+static void glyph_quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, GLuint texture) {
+    if (stream_active()) {
+        stream_quad(x0, y0, x1, y1, u0, v0, u1, v1, 1.0f, 1.0f, 1.0f, 1.0f, texture);
+        return;
+    }
+
+    gls_texture_state(texture);
+    gls_color4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glBegin(GL_TRIANGLES);
+        glTexCoord2f(u0, v0); glVertex2f(x0, y0);   // Top-Left
+        glTexCoord2f(u1, v0); glVertex2f(x1, y0);   // Top-Right
+        glTexCoord2f(u1, v1); glVertex2f(x1, y1);   // Bottom-Right
+
+        glTexCoord2f(u0, v0); glVertex2f(x0, y0);   // Top-Left
+        glTexCoord2f(u1, v1); glVertex2f(x1, y1);   // Bottom-Right
+        glTexCoord2f(u0, v1); glVertex2f(x0, y1);   // Bottom-Left
+    glEnd();
+}
+
+// Draw a glyph from the TrueType cache; returns the pen advance (Code point, X-Position, Y-Position, Size)
+static float draw_cached_glyph(uint32_t codepoint, float x, float y, float size) {
+    const CachedGlyph* glyph = glyph_cache_get(codepoint);
+    if (!glyph) return 0.0f;
+    if (glyph->page >= 0) {
+        float baseline = y - glyph_cache_ascent() * size;
+        float x0 = x + glyph->left * size;
+        float y0 = baseline + glyph->top * size;
+        glyph_quad(x0, y0, x0 + glyph->width * size, y0 - glyph->height * size,
+            glyph->u0, glyph->v0, glyph->u1, glyph->v1, glyph->texture);
+    }
+    return glyph->advance * size;
+}
+
+// Draw an individual character (Character, X-Position, Y-Position, Size)
+void draw_char(char c, float x, float y, float size) {
+    float uv[4];
+    if (!font_cell_uv((unsigned char)c, uv)) return;
+    glyph_quad(x, y, x + size, y - size, uv[0], uv[1], uv[2], uv[3], font_texture);
+}
+
+uint32_t utf8_next(const char** text) {
+    const unsigned char* s = (const unsigned char*)*text;
+    uint32_t c = s[0];
+    int extra = c < 0x80 ? 0 : (c & 0xE0) == 0xC0 ? 1 : (c & 0xF0) == 0xE0 ? 2 : (c & 0xF8) == 0xF0 ? 3 : -1;
+    if (extra < 0) {
+        *text += 1;
+        return 0xFFFD;
+    }
+
+    c &= 0x7F >> extra;
+    for (int i = 1; i <= extra; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *text += i;
+            return 0xFFFD;
+        }
+        c = c << 6 | (s[i] & 0x3F);
+    }
+    *text += extra + 1;
+    return c;
+}
+
+// Draw a string of UTF-8 text (Text, X-Position, Y-Position, Size)
+void draw_text(const char* text, float x, float y, float size) {
+    float start = x;
+    while (*text) {
+        uint32_t c = utf8_next(&text);
+        if (c < 0x80 && font_index(c) != -1) {
+            draw_char((char)c, start, y, size);
+            start += size;
+        } else {
+            start += draw_cached_glyph(c, start, y, size);
+        }
+    }
+}
+
+float text_width(const char* text, float size) {
+    float width = 0.0f;
+    while (*text) {
+        uint32_t c = utf8_next(&text);
+        if (c < 0x80 && font_index(c) != -1) {
+            width += size;
+        } else {
+            const CachedGlyph* glyph = glyph_cache_get(c);
+            if (glyph) width += glyph->advance * size;
+        }
+    }
+    return width;
+}
@@ -0,0 +1,492 @@
+#include "ttf.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_COMPOSITE_DEPTH 8
+#define MAX_OUTLINE_GLYPHS  256       // Components one outline may pull in, so shared composites can't fan out forever
+#define MAX_OUTLINE_LINES   (64 << 10)
+#define MAX_GLYPH_LINES     8         // A bounding box taller or wider than this many lines is corrupt
+
+static uint16_t u16(const unsigned char* p) { return (uint16_t)(p[0] << 8 | p[1]); }
+static int16_t  i16(const unsigned char* p) { return (int16_t)u16(p); }
+static uint32_t u32(const unsigned char* p) { return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]; }
+
+// Whether bytes [offset, offset + length) are inside the font; 64-bit so table offset + length can't wrap
+static int in_font(const TTFont* font, uint64_t offset, uint64_t length) {
+    return offset <= font->size && length <= font->size - offset;
+}
+
+// Offset of a table, 0 if it's missing or shorter than the fields read from it (Font, Tag, Bytes needed)
+static uint32_t find_table(const TTFont* font, const char* tag, uint64_t length) {
+    int count = u16(font->data + 4);
+    if (!in_font(font, 12, (uint64_t)count * 16)) return 0;
+    for (int i = 0; i < count; i++) {
+        const unsigned char* record = font->data + 12 + i * 16;
+        if (memcmp(record, tag, 4) == 0) return in_font(font, u32(record + 8), length) ? u32(record + 8) : 0;
+    }
+    return 0;
+}
+
+// Whether a cmap subtable's header and arrays are all inside the font (Font, Offset, Format)
+static int cmap_valid(const TTFont* font, uint32_t offset, int format) {
+    const unsigned char* table = font->data + offset;
+    if (format == 12) return in_font(font, offset, 16) && in_font(font, offset + 16ull, (uint64_t)u32(table + 12) * 12);
+    return in_font(font, offset, 14) && in_font(font, offset + 14ull, (uint64_t)(u16(table + 6) / 2) * 8 + 2);
+}
+
+int ttf_load(TTFont* font, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = size > 0 && (unsigned long)size <= UINT32_MAX ? malloc(size) : NULL;
+    if (!data || fread(data, 1, size, file) != (size_t)size) {
+        fclose(file);
+        free(data);
+        return 0;
+    }
+    fclose(file);
+
+    if (!ttf_load_memory(font, data, (uint32_t)size)) {
+        free(data);
+        return 0;
+    }
+    font->owns_data = 1;
+    return 1;
+}
+
+int ttf_load_memory(TTFont* font, const unsigned char* data, uint32_t size) {
+    memset(font, 0, sizeof(*font));
+    if (size < 12) return 0;
+    font->data = data;
+    font->size = size;
+
+    uint32_t head = find_table(font, "head", 54);
+    uint32_t hhea = find_table(font, "hhea", 36);
+    uint32_t maxp = find_table(font, "maxp", 6);
+    uint32_t cmap = find_table(font, "cmap", 4);
+    font->glyf = find_table(font, "glyf", 0);
+    if (!head || !hhea || !maxp || !cmap || !font->glyf) {
+        ttf_free(font);
+        return 0;
+    }
+
+    font->units_per_em = u16(font->data + head + 18);
+    font->long_loca = i16(font->data + head + 50) != 0;
+    font->ascent = i16(font->data + hhea + 4);
+    font->descent = i16(font->data + hhea + 6);
+    font->num_hmetrics = u16(font->data + hhea + 34);
+    font->num_glyphs = u16(font->data + maxp + 4);
+
+    // loca has an end entry after the last glyph; hmtx needs at least one metric to fall back on
+    font->loca = find_table(font, "loca", ((uint64_t)font->num_glyphs + 1) * (font->long_loca ? 4 : 2));
+    font->hmtx = find_table(font, "hmtx", (uint64_t)font->num_hmetrics * 4);
+    if (!font->loca || !font->hmtx || font->num_hmetrics == 0 || font->ascent <= font->descent) {
+        ttf_free(font);
+        return 0;
+    }
+
+    // Prefer the full-Unicode subtable, fall back to the BMP one
+    int subtables = u16(font->data + cmap + 2);
+    if (!in_font(font, cmap + 4ull, (uint64_t)subtables * 8)) subtables = 0;
+    for (int i = 0; i < subtables; i++) {
+        const unsigned char* record = font->data + cmap + 4 + i * 8;
+        int platform = u16(record), encoding = u16(record + 2);
+        uint64_t offset = (uint64_t)cmap + u32(record + 4);
+        int unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        if (!unicode || !in_font(font, offset, 2)) continue;
+        int format = u16(font->data + offset);
+        if ((format != 12 && format != 4) || !cmap_valid(font, (uint32_t)offset, format)) continue;
+        if (format == 12) { font->cmap = (uint32_t)offset; break; }
+        if (!font->cmap) font->cmap = (uint32_t)offset;
+    }
+    if (!font->cmap) {
+        ttf_free(font);
+        return 0;
+    }
+    return 1;
+}
+
+void ttf_free(TTFont* font) {
+    if (font->owns_data) free((void*)font->data);
+    font->data = NULL;
+}
+
+// Glyph index from the cmap, 0 if the font has no such glyph (Font, Index from the table)
+static int checked_index(const TTFont* font, uint32_t index) {
+    return index < (uint32_t)font->num_glyphs ? (int)index : 0;
+}
+
+int ttf_glyph_index(const TTFont* font, uint32_t codepoint) {
+    // cmap_valid already checked the subtable's arrays; only the format 4 glyph array below is read unchecked
+    const unsigned char* table = font->data + font->cmap;
+
+    if (u16(table) == 12) {
+        uint32_t groups = u32(table + 12);
+        uint32_t lo = 0, hi = groups;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            const unsigned char* group = table + 16 + (size_t)mid * 12;
+            if (codepoint < u32(group)) hi = mid;
+            else if (codepoint > u32(group + 4)) lo = mid + 1;
+            else return checked_index(font, u32(group + 8) + codepoint - u32(group));
+        }
+        return 0;
+    }
+
+    // Format 4: segments of the BMP
+    if (codepoint > 0xFFFF) return 0;
+    int segments = u16(table + 6) / 2;
+    const unsigned char* end_codes = table + 14;
+    const unsigned char* start_codes = end_codes + segments * 2 + 2;
+    const unsigned char* deltas = start_codes + segments * 2;
+    const unsigned char* range_offsets = deltas + segments * 2;
+
+    for (int i = 0; i < segments; i++) {
+        if (codepoint > u16(end_codes + i * 2)) continue;
+        uint16_t start = u16(start_codes + i * 2);
+        if (codepoint < start) return 0;
+        uint16_t range = u16(range_offsets + i * 2);
+        if (range == 0) return checked_index(font, (uint16_t)(codepoint + i16(deltas + i * 2)));
+        uint64_t glyph = (uint64_t)(range_offsets - font->data) + i * 2 + range + (codepoint - start) * 2;
+        if (!in_font(font, glyph, 2)) return 0;
+        uint16_t index = u16(font->data + glyph);
+        return index ? checked_index(font, (uint16_t)(index + i16(deltas + i * 2))) : 0;
+    }
+    return 0;
+}
+
+// Where a glyph's glyf data starts; length 0 if it is empty or runs out of the font (Font, Glyph in [0, num_glyphs), Output length)
+static uint32_t glyph_offset(const TTFont* font, int glyph, uint32_t* length) {
+    uint32_t start, end;
+    if (font->long_loca) {
+        start = u32(font->data + font->loca + glyph * 4);
+        end = u32(font->data + font->loca + glyph * 4 + 4);
+    } else {
+        start = u16(font->data + font->loca + glyph * 2) * 2u;
+        end = u16(font->data + font->loca + glyph * 2 + 2) * 2u;
+    }
+    if (end < start || !in_font(font, (uint64_t)font->glyf + start, end - start)) {
+        *length = 0;
+        return 0;
+    }
+    *length = end - start;
+    return font->glyf + start;
+}
+
+/* Flattened outline as a growable list of line segments (pixel space, y down) */
+
+typedef struct {
+    float x0, y0, x1, y1;
+} Line;
+
+typedef struct {
+    Line* lines;
+    int count, capacity;
+    int glyphs;   // Glyphs emitted so far, components included
+    float m[6];   // Font units -> pixels: x' = m0*x + m2*y + m4, y' = m1*x + m3*y + m5
+} Outline;
+
+// Lines past MAX_OUTLINE_LINES, or that don't fit in memory, are dropped
+static void add_line(Outline* outline, float x0, float y0, float x1, float y1) {
+    if (outline->count == outline->capacity) {
+        if (outline->capacity == MAX_OUTLINE_LINES) return;
+        int capacity = outline->capacity ? outline->capacity * 2 : 64;
+        Line* lines = realloc(outline->lines, capacity * sizeof(Line));
+        if (!lines) return;
+        outline->lines = lines;
+        outline->capacity = capacity;
+    }
+    outline->lines[outline->count++] = (Line){x0, y0, x1, y1};
+}
+
+static void add_quad(Outline* outline, float x0, float y0, float cx, float cy, float x1, float y1) {
+    float dd = fabsf(x0 - 2 * cx + x1) + fabsf(y0 - 2 * cy + y1);
+    int steps = 1 + (int)sqrtf(dd * 4.0f);
+    if (steps > 16) steps = 16;
+    float px = x0, py = y0;
+    for (int i = 1; i <= steps; i++) {
+        float t = (float)i / steps, mt = 1.0f - t;
+        float nx = mt * mt * x0 + 2 * mt * t * cx + t * t * x1;
+        float ny = mt * mt * y0 + 2 * mt * t * cy + t * t * y1;
+        add_line(outline, px, py, nx, ny);
+        px = nx; py = ny;
+    }
+}
+
+static void transform(const float* m, float x, float y, float* ox, float* oy) {
+    *ox = m[0] * x + m[2] * y + m[4];
+    *oy = m[1] * x + m[3] * y + m[5];
+}
+
+static void emit_glyph(const TTFont* font, int glyph, Outline* outline, int depth);
+
+// A glyph whose data runs past its end, or whose contours end past its points, is dropped whole (Glyph data, Length, Contours, Outline)
+static void emit_simple(const unsigned char* g, uint32_t length, int contours, Outline* outline) {
+    const unsigned char* limit = g + length;
+    const unsigned char* end_points = g + 10;
+    if (12 + (uint32_t)contours * 2 > length) return;
+    int points = u16(end_points + (contours - 1) * 2) + 1;
+    int instructions = u16(end_points + contours * 2);
+    const unsigned char* p = end_points + contours * 2 + 2;
+    if (instructions > limit - p) return;
+    p += instructions;
+    for (int c = 0; c < contours; c++) {
+        if (u16(end_points + c * 2) >= points) return;
+    }
+
+    unsigned char* flags = malloc(points);
+    float* xs = malloc(points * sizeof(float) * 2);
+    float* ys = xs + points;
+    if (!flags || !xs) {
+        free(flags);
+        free(xs);
+        return;
+    }
+
+    int count = 0;
+    while (count < points && p < limit) {
+        unsigned char flag = *p++;
+        int repeat = 0;
+        if (flag & 8) {
+            if (p == limit) break;
+            repeat = *p++;
+        }
+        for (int r = 0; r <= repeat && count < points; r++) flags[count++] = flag;
+    }
+
+    /* Coordinates are 0, 1 or 2 bytes each, as the flags say; size them all before reading any */
+    ptrdiff_t coordinate_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        coordinate_bytes += (flags[i] & 2) ? 1 : (flags[i] & 16) ? 0 : 2;
+        coordinate_bytes += (flags[i] & 4) ? 1 : (flags[i] & 32) ? 0 : 2;
+    }
+    if (count < points || coordinate_bytes > limit - p) {
+        free(flags);
+        free(xs);
+        return;
+    }
+
+    int value = 0;
+    for (int i = 0; i < points; i++) {
+        if (flags[i] & 2) { value += (flags[i] & 16) ? *p : -*p; p++; }
+        else if (!(flags[i] & 16)) { value += i16(p); p += 2; }
+        xs[i] = (float)value;
+    }
+    value = 0;
+    for (int i = 0; i < points; i++) {
+        if (flags[i] & 4) { value += (flags[i] & 32) ? *p : -*p; p++; }
+        else if (!(flags[i] & 32)) { value += i16(p); p += 2; }
+        ys[i] = (float)value;
+    }
+    for (int i = 0; i < points; i++) transform(outline->m, xs[i], ys[i], &xs[i], &ys[i]);
+
+    int start = 0;
+    for (int c = 0; c < contours; c++) {
+        int end = u16(end_points + c * 2);
+        int n = end - start + 1;
+        if (n < 2) { start = end + 1; continue; }
+
+        // Start from an on-curve point, or the midpoint of two off-curve ones
+        int first = -1;
+        for (int i = 0; i < n; i++) if (flags[start + i] & 1) { first = i; break; }
+        float sx, sy;
+        if (first >= 0) {
+            sx = xs[start + first]; sy = ys[start + first];
+        } else {
+            first = 0;
+            sx = (xs[start] + xs[start + n - 1]) * 0.5f;
+            sy = (ys[start] + ys[start + n - 1]) * 0.5f;
+        }
+
+        float px = sx, py = sy, cx = 0, cy = 0;
+        int have_control = 0;
+        for (int k = 1; k <= n; k++) {
+            int i = start + (first + k) % n;
+            float x = xs[i], y = ys[i];
+            if (flags[i] & 1) {
+                if (have_control) add_quad(outline, px, py, cx, cy, x, y);
+                else add_line(outline, px, py, x, y);
+                px = x; py = y;
+                have_control = 0;
+            } else {
+                if (have_control) {
+                    float mx = (cx + x) * 0.5f, my = (cy + y) * 0.5f;
+                    add_quad(outline, px, py, cx, cy, mx, my);
+                    px = mx; py = my;
+                }
+                cx = x; cy = y;
+                have_control = 1;
+            }
+        }
+        if (have_control) add_quad(outline, px, py, cx, cy, sx, sy);
+        else if (px != sx || py != sy) add_line(outline, px, py, sx, sy);
+        start = end + 1;
+    }
+    free(flags);
+    free(xs);
+}
+
+// Component records up to the glyph's end; a truncated record ends the list (Font, Records, End of glyph data, Outline, Depth)
+static void emit_composite(const TTFont* font, const unsigned char* p, const unsigned char* limit, Outline* outline, int depth) {
+    float parent[6];
+    memcpy(parent, outline->m, sizeof(parent));
+
+    for (;;) {
+        if (limit - p < 4) break;
+        uint16_t flags = u16(p), component = u16(p + 2);
+        p += 4;
+        int arguments = ((flags & 1) ? 4 : 2) + ((flags & 8) ? 2 : (flags & 0x40) ? 4 : (flags & 0x80) ? 8 : 0);
+        if (limit - p < arguments) break;
+        float dx, dy;
+        if (flags & 1) { dx = i16(p); dy = i16(p + 2); p += 4; }
+        else { dx = (signed char)p[0]; dy = (signed char)p[1]; p += 2; }
+
+        float a = 1, b = 0, c = 0, d = 1;
+        if (flags & 8) { a = d = i16(p) / 16384.0f; p += 2; }
+        else if (flags & 0x40) { a = i16(p) / 16384.0f; d = i16(p + 2) / 16384.0f; p += 4; }
+        else if (flags & 0x80) { a = i16(p) / 16384.0f; b = i16(p + 2) / 16384.0f; c = i16(p + 4) / 16384.0f; d = i16(p + 6) / 16384.0f; p += 8; }
+
+        // Point-matching offsets (ARGS_ARE_XY_VALUES unset) are rare; treat them as zero
+        if (!(flags & 2)) dx = dy = 0;
+
+        // child = parent * [a c dx; b d dy]
+        outline->m[0] = parent[0] * a + parent[2] * b;
+        outline->m[1] = parent[1] * a + parent[3] * b;
+        outline->m[2] = parent[0] * c + parent[2] * d;
+        outline->m[3] = parent[1] * c + parent[3] * d;
+        outline->m[4] = parent[0] * dx + parent[2] * dy + parent[4];
+        outline->m[5] = parent[1] * dx + parent[3] * dy + parent[5];
+        emit_glyph(font, component, outline, depth + 1);
+
+        if (!(flags & 0x20)) break;
+    }
+    memcpy(outline->m, parent, sizeof(parent));
+}
+
+static void emit_glyph(const TTFont* font, int glyph, Outline* outline, int depth) {
+    if (glyph < 0 || glyph >= font->num_glyphs || depth > MAX_COMPOSITE_DEPTH) return;
+    if (++outline->glyphs > MAX_OUTLINE_GLYPHS) return;
+    uint32_t length;
+    uint32_t offset = glyph_offset(font, glyph, &length);
+    if (length < 10) return;
+
+    const unsigned char* g = font->data + offset;
+    int contours = i16(g);
+    if (contours > 0) emit_simple(g, length, contours, outline);
+    else if (contours < 0) emit_composite(font, g + 10, g + length, outline, depth);
+}
+
+/* Exact-area scan conversion: every line deposits signed area into an accumulation
+   buffer, and a running sum along each row turns that into coverage. Outlines that
+   stray outside the bounding box (a lying or corrupt font) are clamped to it. */
+
+static void raster_line(float* acc, int w, int h, Line l) {
+    if (l.y0 == l.y1) return;
+    float dir = 1.0f;
+    if (l.y0 > l.y1) {
+        dir = -1.0f;
+        Line t = {l.x1, l.y1, l.x0, l.y0};
+        l = t;
+    }
+    if (!(l.y1 > 0.0f && l.y0 < (float)h)) return;   // Also drops NaN
+    float dxdy = (l.x1 - l.x0) / (l.y1 - l.y0);
+    float x = l.x0;
+    if (l.y0 < 0.0f) x -= l.y0 * dxdy;
+
+    int y_end = l.y1 >= (float)h ? h : (int)ceilf(l.y1);
+    for (int y = l.y0 < 0 ? 0 : (int)l.y0; y < y_end; y++) {
+        float* row = acc + y * w;
+        float dy = fminf((float)(y + 1), l.y1) - fmaxf((float)y, l.y0);
+        float x_next = x + dxdy * dy;
+        float d = dy * dir;
+        // Span clamped to [0, w]: the writes below reach row[w + 1] at most, which the spare cells cover
+        float x0 = fminf(fmaxf(fminf(x, x_next), 0.0f), (float)w);
+        float x1 = fminf(fmaxf(fmaxf(x, x_next), 0.0f), (float)w);
+        float x0_floor = floorf(x0);
+        int x0i = (int)x0_floor;
+        float x1_ceil = ceilf(x1);
+        int x1i = (int)x1_ceil;
+
+        if (x1i <= x0i + 1) {
+            float xmf = 0.5f * (x0 + x1) - x0_floor;
+            row[x0i] += d - d * xmf;
+            row[x0i + 1] += d * xmf;
+        } else {
+            float s = 1.0f / (x1 - x0);
+            float x0f = x0 - x0_floor;
+            float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+            float x1f = x1 - x1_ceil + 1.0f;
+            float am = 0.5f * s * x1f * x1f;
+            row[x0i] += d * a0;
+            if (x1i == x0i + 2) {
+                row[x0i + 1] += d * (1.0f - a0 - am);
+            } else {
+                float a1 = s * (1.5f - x0f);
+                row[x0i + 1] += d * (a1 - a0);
+                for (int xi = x0i + 2; xi < x1i - 1; xi++) row[xi] += d * s;
+                float a2 = a1 + (x1i - x0i - 3) * s;
+                row[x1i - 1] += d * (1.0f - a2 - am);
+            }
+            row[x1i] += d * am;
+        }
+        x = x_next;
+    }
+}
+
+int ttf_rasterize(const TTFont* font, int glyph, float line_px, int pad, TTGlyphBitmap* out) {
+    memset(out, 0, sizeof(*out));
+    float scale = line_px / (float)(font->ascent - font->descent);
+
+    int advance_index = glyph < 0 ? 0 : glyph < font->num_hmetrics ? glyph : font->num_hmetrics - 1;
+    out->advance = u16(font->data + font->hmtx + advance_index * 4) * scale;
+    if (glyph <= 0 || glyph >= font->num_glyphs) return 1;
+
+    uint32_t length;
+    uint32_t offset = glyph_offset(font, glyph, &length);
+    if (length < 10) return 1;   // Blank glyph, e.g. space
+
+    const unsigned char* g = font->data + offset;
+    float x_min = i16(g + 2) * scale, y_min = i16(g + 4) * scale;
+    float x_max = i16(g + 6) * scale, y_max = i16(g + 8) * scale;
+
+    int width = (int)(ceilf(x_max) - floorf(x_min)) + pad * 2;
+    int height = (int)(ceilf(y_max) - floorf(y_min)) + pad * 2;
+    int max_size = (int)(line_px * MAX_GLYPH_LINES) + pad * 2;
+    if (width <= 0 || height <= 0 || width > max_size || height > max_size) return 0;
+    out->left = floorf(x_min) - pad;
+    out->top = ceilf(y_max) + pad;
+    out->width = width;
+    out->height = height;
+
+    Outline outline = {0};
+    float m[6] = { scale, 0, 0, -scale, -out->left, out->top };
+    memcpy(outline.m, m, sizeof(m));
+    emit_glyph(font, glyph, &outline, 0);
+
+    // Two spare cells: the last line of a row writes one past the right edge
+    int w = out->width, h = out->height;
+    float* acc = calloc((size_t)w * h + 2, sizeof(float));
+    out->coverage = acc ? malloc((size_t)w * h) : NULL;
+    if (!out->coverage) {
+        free(acc);
+        free(outline.lines);
+        return 0;
+    }
+    for (int i = 0; i < outline.count; i++) raster_line(acc, w, h, outline.lines[i]);
+    free(outline.lines);
+
+    float sum = 0.0f;
+    for (int i = 0; i < w * h; i++) {
+        sum += acc[i];
+        float a = fabsf(sum);
+        out->coverage[i] = (unsigned char)((a > 1.0f ? 1.0f : a) * 255.0f + 0.5f);
+    }
+    free(acc);
+    return 1;
+}
@@ -1,7 +1,6 @@
 #include "utils.h"
 #include <unistd.h>
-
-#include <GLFW/glfw3.h>
+#include <time.h>
 
 float clamp(float value, float min, float max) {
     if (value < min) return min;
@@ -9,6 +8,25 @@ float clamp(float value, float min, float max) {
     else return value;
 }
 
+// Monotonic time in nanoseconds (not tied to glfwGetTime, so it works off the main thread)
+uint64_t time_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+uint64_t percentile(const uint64_t* sorted, int n, double p) {
+    int rank = (int)(p / 100.0 * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
 // void sleep(int microseconds) {
 //     usleep(microseconds * glfwGetTime());
-// }
\ No newline at end of file
+// }
@@ -0,0 +1,168 @@
+#include "vertex_stream.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SEGMENT_COUNT 3
+#define SEGMENT_VERTS 16384   // 2730 quads per segment
+
+StreamStats stream_stats;
+
+static struct {
+    int active;
+    int suspended;            // Callers draw immediately for now (benchmarks)
+    GLuint buffer;
+    StreamVertex* mapped;     // Persistent mapping of the whole ring, or NULL
+    StreamVertex* staging;    // CPU-side array for the orphaning fallback
+    GLExtSync fences[SEGMENT_COUNT];
+    int segment;              // Segment being written
+    int cursor;               // Next free vertex within the segment
+    int batch_start;          // First vertex not yet drawn
+    GLuint batch_texture;
+    int segment_ready;        // Fence for this segment already waited on
+} ring;
+
+int stream_init(void) {
+    if (!gl_ext.has_vbo) return 0;
+
+    gl_ext.gen_buffers(1, &ring.buffer);
+    gl_ext.bind_buffer(GL_ARRAY_BUFFER, ring.buffer);
+
+    ptrdiff_t size = (ptrdiff_t)SEGMENT_COUNT * SEGMENT_VERTS * sizeof(StreamVertex);
+    if (gl_ext.has_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        gl_ext.buffer_storage(GL_ARRAY_BUFFER, size, NULL, flags);
+        ring.mapped = gl_ext.map_buffer_range(GL_ARRAY_BUFFER, 0, size, flags);
+    }
+    if (!ring.mapped) {
+        ring.staging = malloc(SEGMENT_VERTS * sizeof(StreamVertex));
+        if (!ring.staging) {
+            gl_ext.bind_buffer(GL_ARRAY_BUFFER, 0);
+            gl_ext.delete_buffers(1, &ring.buffer);
+            ring.buffer = 0;
+            return 0;
+        }
+    }
+    stream_stats.persistent = ring.mapped != NULL;
+
+    ring.active = 1;
+    stream_bind_arrays();
+    return 1;
+}
+
+// Attribute layout never changes, so the client arrays are only set up again after someone else's draw
+void stream_bind_arrays(void) {
+    if (!ring.active) return;
+    gl_ext.bind_buffer(GL_ARRAY_BUFFER, ring.buffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(StreamVertex), (void*)offsetof(StreamVertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(StreamVertex), (void*)offsetof(StreamVertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(StreamVertex), (void*)offsetof(StreamVertex, r));
+}
+
+void stream_shutdown(void) {
+    if (!ring.active) return;
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        if (ring.fences[i]) gl_ext.delete_sync(ring.fences[i]);
+    }
+    gl_ext.delete_buffers(1, &ring.buffer);
+    free(ring.staging);
+    ring.active = 0;
+}
+
+int stream_active(void) {
+    return ring.active && !ring.suspended;
+}
+
+void stream_suspend(int suspend) {
+    stream_flush();
+    ring.suspended = suspend;
+}
+
+// Block until the GPU has finished reading the segment we are about to overwrite
+static void wait_segment(int segment) {
+    if (!ring.fences[segment]) return;
+    while (gl_ext.client_wait_sync(ring.fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED);
+    gl_ext.delete_sync(ring.fences[segment]);
+    ring.fences[segment] = NULL;
+}
+
+void stream_flush(void) {
+    int count = ring.cursor - ring.batch_start;
+    if (count <= 0) return;
+
+    gls_texture_state(ring.batch_texture);
+
+    if (ring.mapped) {
+        int first = ring.segment * SEGMENT_VERTS + ring.batch_start;
+        glDrawArrays(GL_TRIANGLES, first, count);
+    } else {
+        // Orphan the old storage so the driver never waits on the previous draw
+        gl_ext.buffer_data(GL_ARRAY_BUFFER, count * sizeof(StreamVertex), ring.staging + ring.batch_start, GL_STREAM_DRAW);
+        glDrawArrays(GL_TRIANGLES, 0, count);
+    }
+    gls_invalidate_color();
+
+    stream_stats.bytes += count * sizeof(StreamVertex);
+    stream_stats.draws++;
+    ring.batch_start = ring.cursor;
+}
+
+// Fence the current segment and move on to the next one
+static void next_segment(void) {
+    if (ring.mapped) {
+        ring.fences[ring.segment] = gl_ext.fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ring.segment = (ring.segment + 1) % SEGMENT_COUNT;
+        ring.segment_ready = 0;
+    }
+    ring.cursor = ring.batch_start = 0;
+}
+
+void stream_quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1,
+    float r, float g, float b, float a, GLuint texture) {
+    if (texture != ring.batch_texture) {
+        stream_flush();
+        ring.batch_texture = texture;
+    }
+    if (ring.cursor + 6 > SEGMENT_VERTS) {
+        stream_flush();
+        next_segment();
+    }
+    if (ring.mapped && !ring.segment_ready) {
+        wait_segment(ring.segment);
+        ring.segment_ready = 1;
+    }
+
+    StreamVertex* base = ring.mapped ? ring.mapped + ring.segment * SEGMENT_VERTS : ring.staging;
+    StreamVertex* v = base + ring.cursor;
+    unsigned char cr = (unsigned char)(r * 255.0f + 0.5f);
+    unsigned char cg = (unsigned char)(g * 255.0f + 0.5f);
+    unsigned char cb = (unsigned char)(b * 255.0f + 0.5f);
+    unsigned char ca = (unsigned char)(a * 255.0f + 0.5f);
+
+    v[0] = (StreamVertex){x0, y0, u0, v0, cr, cg, cb, ca};
+    v[1] = (StreamVertex){x1, y0, u1, v0, cr, cg, cb, ca};
+    v[2] = (StreamVertex){x1, y1, u1, v1, cr, cg, cb, ca};
+    v[3] = v[0];
+    v[4] = v[2];
+    v[5] = (StreamVertex){x0, y1, u0, v1, cr, cg, cb, ca};
+    ring.cursor += 6;
+}
+
+void stream_end_frame(void) {
+    if (!ring.active) return;
+    stream_flush();
+    next_segment();
+
+    stream_stats.total_bytes += stream_stats.bytes;
+    if (gls_debug && (gls_stats.frames + 1) % 60 == 0) {
+        fprintf(stderr, "vertex_stream: %lu bytes in %u draws this frame (%s)\n",
+            stream_stats.bytes, stream_stats.draws, ring.mapped ? "persistent ring" : "orphaned glBufferData");
+    }
+    stream_stats.bytes = 0;
+    stream_stats.draws = 0;
+}
@@ -0,0 +1,134 @@
+#include "wall.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WALL_TICK_RATE 60.0
+#define MAX_CATCH_UP   8        // Ticks per update at most; beyond that the wall just falls behind
+#define TILE_GAP       0.01f    // Between tiles, in -1..1 units
+#define BOT_DEAD_ZONE  0.03f
+
+// Same xorshift32 as the game, for per-court seeds and bot reaction
+static uint32_t wall_rand(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Chase the ball with a paddle once it is coming and close enough (Paddle, Ball, Ball is coming, Reaction, Up bit, Down bit)
+static unsigned bot_paddle(const Paddle* paddle, const Ball* ball, int coming, float reaction, unsigned up, unsigned down) {
+    float centre = paddle->y + paddle->h / 2.0f;
+    float target = coming && fabsf(ball->x - paddle->x) < reaction ? ball->y : 0.0f;
+    if (target > centre + BOT_DEAD_ZONE) return up;
+    if (target < centre - BOT_DEAD_ZONE) return down;
+    return 0;
+}
+
+static unsigned bot_buttons(const GameState* state, float reaction) {
+    const Ball* ball = &state->ball;
+    return bot_paddle(&state->left, ball, ball->vx < 0.0f, reaction, INPUT_LEFT_UP, INPUT_LEFT_DOWN)
+         | bot_paddle(&state->right, ball, ball->vx > 0.0f, reaction, INPUT_RIGHT_UP, INPUT_RIGHT_DOWN);
+}
+
+// Fresh match for a court; a replayed one gets the player count and physics core it was recorded with
+static void restart_court(WallCourt* court) {
+    game_init(&court->state, court->seed);
+    if (!court->has_replay) return;
+    game_set_players(&court->state, court->replay.players);
+    game_set_fixed_point(&court->state, court->replay.fixed_point);
+}
+
+int wall_init(Wall* wall, int count, const char* const* replay_paths, int replay_count) {
+    if (replay_count > count) count = replay_count;
+    wall->courts = calloc(count, sizeof(WallCourt));
+    if (!wall->courts) {
+        fprintf(stderr, "Out of memory for a wall of %d courts\n", count);
+        return 0;
+    }
+    wall->count = count;
+    wall->cols = (int)ceil(sqrt((double)count));
+    wall->rows = (count + wall->cols - 1) / wall->cols;
+    wall->tick_rate = WALL_TICK_RATE;
+    wall->last_ns = 0;
+    wall->accumulator_ns = 0;
+
+    uint32_t rng = 0x9E3779B9u;
+    for (int i = 0; i < count; i++) {
+        WallCourt* court = &wall->courts[i];
+        if (i < replay_count) {
+            if (!replay_load(&court->replay, replay_paths[i])) {
+                fprintf(stderr, "Could not load replay: %s\n", replay_paths[i]);
+                wall->count = i;
+                wall_free(wall);
+                return 0;
+            }
+            court->has_replay = 1;
+            court->seed = court->replay.seed;
+        } else {
+            court->seed = wall_rand(&rng);
+        }
+        // 0.6..1.6: the slow end misses now and then, so scores keep moving
+        court->reaction = 0.6f + (wall_rand(&rng) % 1000) / 1000.0f;
+        restart_court(court);
+    }
+    return 1;
+}
+
+void wall_free(Wall* wall) {
+    for (int i = 0; i < wall->count; i++) {
+        if (wall->courts[i].has_replay) replay_free(&wall->courts[i].replay);
+    }
+    free(wall->courts);
+    wall->courts = NULL;
+    wall->count = 0;
+}
+
+static void court_step(WallCourt* court) {
+    if (!court->has_replay) {
+        game_step(&court->state, bot_buttons(&court->state, court->reaction));
+        return;
+    }
+    if (court->state.tick >= court->replay.end_tick) {
+        restart_court(court);
+        court->cursor = 0;
+    }
+    game_step(&court->state, replay_buttons(&court->replay, court->state.tick, &court->cursor));
+}
+
+void wall_update(Wall* wall, uint64_t now_ns) {
+    uint64_t period = (uint64_t)(1e9 / wall->tick_rate);
+    if (wall->last_ns == 0) wall->last_ns = now_ns;
+    wall->accumulator_ns += now_ns - wall->last_ns;
+    wall->last_ns = now_ns;
+
+    int ticks = 0;
+    while (wall->accumulator_ns >= period && ticks < MAX_CATCH_UP) {
+        for (int i = 0; i < wall->count; i++) court_step(&wall->courts[i]);
+        wall->accumulator_ns -= period;
+        ticks++;
+    }
+    if (ticks == MAX_CATCH_UP) wall->accumulator_ns = 0;
+}
+
+void wall_scene(const Wall* wall, int index, Scene* scene) {
+    scene_game(scene, &wall->courts[index].state);
+
+    /* Tile in the grid, filled top-left first */
+    float tile_w = 2.0f / wall->cols, tile_h = 2.0f / wall->rows;
+    int col = index % wall->cols, row = index / wall->cols;
+    float x = -1.0f + col * tile_w + TILE_GAP / 2.0f;
+    float y = 1.0f - (row + 1) * tile_h + TILE_GAP / 2.0f;
+    scene_fit(scene, x, y, tile_w - TILE_GAP, tile_h - TILE_GAP);
+
+    // The court's own background goes under everything else in the tile
+    if (scene->rect_count == SCENE_MAX_RECTS) scene->rect_count--;
+    memmove(&scene->rects[1], &scene->rects[0], scene->rect_count * sizeof(SceneRect));
+    scene->rects[0] = (SceneRect){ x, y, tile_w - TILE_GAP, tile_h - TILE_GAP,
+        scene->background[0], scene->background[1], scene->background[2], 1.0f };
+    scene->rect_count++;
+    scene->background[0] = scene->background[1] = scene->background[2] = 0.05f;
+}
@@ -0,0 +1,51 @@
+#include "y4m.h"
+
+size_t y4m_frame_size(int width, int height) {
+    size_t chroma = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+    return (size_t)width * height + chroma * 2;
+}
+
+void y4m_write_header(FILE* out, int width, int height, double fps) {
+    if (fps <= 0.0) fps = 60.0;
+    fprintf(out, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C420jpeg\n", width, height, (int)(fps * 1000.0 + 0.5));
+}
+
+void y4m_convert(const unsigned char* rgba, int width, int height, int bottom_up, unsigned char* planes) {
+    int w = width, h = height;
+    int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    unsigned char* y_plane = planes;
+    unsigned char* u_plane = y_plane + w * h;
+    unsigned char* v_plane = u_plane + cw * ch;
+
+#define ROW(y) (rgba + (size_t)(bottom_up ? h - 1 - (y) : (y)) * w * 4)
+    for (int y = 0; y < h; y++) {
+        const unsigned char* row = ROW(y);
+        for (int x = 0; x < w; x++) {
+            const unsigned char* p = row + x * 4;
+            y_plane[y * w + x] = (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8);
+        }
+    }
+    for (int cy = 0; cy < ch; cy++) {
+        for (int cx = 0; cx < cw; cx++) {
+            /* Average the 2x2 block, clamped at odd edges */
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                const unsigned char* row = ROW(cy * 2 + dy < h ? cy * 2 + dy : h - 1);
+                for (int dx = 0; dx < 2; dx++) {
+                    int x = cx * 2 + dx < w ? cx * 2 + dx : w - 1;
+                    r += row[x * 4 + 0];
+                    g += row[x * 4 + 1];
+                    b += row[x * 4 + 2];
+                }
+            }
+            u_plane[cy * cw + cx] = (unsigned char)(((-43 * r - 85 * g + 128 * b) >> 10) + 128);
+            v_plane[cy * cw + cx] = (unsigned char)(((128 * r - 107 * g - 21 * b) >> 10) + 128);
+        }
+    }
+#undef ROW
+}
+
+void y4m_write_frame(FILE* out, const unsigned char* planes, int width, int height) {
+    fputs("FRAME\n", out);
+    fwrite(planes, 1, y4m_frame_size(width, height), out);
+}
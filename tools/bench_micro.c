@@ -0,0 +1,437 @@
+// Micro-benchmarks for the physics, text and asset hot paths, as JSON on stdout
+// cc -O2 -Iinclude tools/bench_micro.c src/court.c src/decode_arena.c src/game.c src/multiball.c src/particles.c src/png_decode.c src/text.c src/sdf.c src/glyph_cache.c src/ttf.c src/asset_pack.c src/gl_ext.c src/gl_state.c src/startup.c src/vertex_stream.c src/utils.c -lglfw -framework OpenGL -lm -lpthread -o bench_micro
+// ./bench_micro [--samples n] [--filter name] [--font font.png] > bench.json
+
+#include "court.h"
+#include "decode_arena.h"
+#include "game.h"
+#include "multiball.h"
+#include "particles.h"
+#include "png_decode.h"
+#include "sdf.h"
+#include "stb_image.h"
+#include "text.h"
+#include "utils.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Each benchmark runs its operation in batches. The batch size is doubled until one batch
+   takes SAMPLE_NS, batches then run for WARMUP_NS untimed (caches, branch predictors,
+   CPU clocks), and finally every sample times one batch. Statistics are over the
+   samples' per-operation times, so the timer's own cost is spread over a whole batch. */
+
+#define SAMPLE_NS  2000000ull     // Batch length to calibrate for
+#define WARMUP_NS  200000000ull
+
+typedef struct {
+    const char* name;
+    const char* about;
+    int (*setup)(void);           // Returns 0 to skip the benchmark; may be NULL
+    void (*run)(uint64_t iterations);
+} Bench;
+
+// Results go here so the compiler can't drop the work
+static volatile float sink_float;
+static volatile int sink_int;
+
+static const char* font_path = "font.png";
+
+/* Physics */
+
+static GameState physics_state;
+
+static int physics_setup(void) {
+    game_init(&physics_state, 1);
+    return 1;
+}
+
+static void physics_tick(uint64_t iterations) {
+    uint32_t input = 12345;
+    for (uint64_t i = 0; i < iterations; i++) {
+        input = input * 1103515245u + 12345u;
+        game_step(&physics_state, (input >> 16) & 15u);
+    }
+    sink_float = physics_state.ball.x;
+}
+
+static GameState four_player_state;
+
+static int four_player_setup(void) {
+    game_init(&four_player_state, 1);
+    game_set_players(&four_player_state, 4);
+    return 1;
+}
+
+static void four_player_tick(uint64_t iterations) {
+    uint32_t input = 12345;
+    for (uint64_t i = 0; i < iterations; i++) {
+        input = input * 1103515245u + 12345u;
+        game_step(&four_player_state, (input >> 16) & 255u);
+    }
+    sink_float = four_player_state.ball.x;
+}
+
+static GameState fixed_state;
+
+static int fixed_setup(void) {
+    game_init(&fixed_state, 1);
+    game_set_fixed_point(&fixed_state, 1);
+    return 1;
+}
+
+static void fixed_tick(uint64_t iterations) {
+    uint32_t input = 12345;
+    for (uint64_t i = 0; i < iterations; i++) {
+        input = input * 1103515245u + 12345u;
+        game_step(&fixed_state, (input >> 16) & 15u);
+    }
+    sink_float = fixed_state.ball.x;
+}
+
+/* Batch throughput: many independent matches stepped one tick each, as a lockstep
+   server or a replay checker would; one op is a tick of every match */
+
+#define BATCH_MATCHES 1024
+
+static GameState batch_states[BATCH_MATCHES];
+
+// Matches on different seeds, the fixed-point core or not (1 = fixed point)
+static void batch_setup(int fixed_point) {
+    for (int i = 0; i < BATCH_MATCHES; i++) {
+        game_init(&batch_states[i], i + 1);
+        game_set_fixed_point(&batch_states[i], fixed_point);
+    }
+}
+
+static int batch_float_setup(void) {
+    batch_setup(0);
+    return 1;
+}
+
+static int batch_fixed_setup(void) {
+    batch_setup(1);
+    return 1;
+}
+
+static void batch_tick(uint64_t iterations) {
+    uint32_t input = 12345;
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (int j = 0; j < BATCH_MATCHES; j++) {
+            input = input * 1103515245u + 12345u;
+            game_step(&batch_states[j], (input >> 16) & 15u);
+        }
+    }
+    sink_float = batch_states[0].ball.x;
+}
+
+static void paddle_collision(uint64_t iterations) {
+    Paddle paddle = { -0.9f, -0.15f, 0.05f, 0.3f };
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        // Every contact point down the paddle face, so the angle clamps all get taken
+        Ball ball = { -0.84f, -0.15f + (float)(i % 31) * 0.01f, 0.03f, -0.01f, 0.015f };
+        game_bounce_paddle(&ball, &paddle, 1);
+        acc += ball.vy;
+    }
+    sink_float = acc;
+}
+
+/* A dense court: a 14 x 14 lattice of alternating posts and pillars, 196 obstacles */
+static Court court;
+
+static int court_setup(void) {
+    court_free(&court);
+    for (int row = 0; row < 14; row++) {
+        for (int col = 0; col < 14; col++) {
+            float x = -0.91f + col * 0.14f, y = -0.91f + row * 0.14f;
+            if ((row + col) % 2) court_add_rect(&court, x - 0.02f, y - 0.02f, 0.04f, 0.04f);
+            else court_add_circle(&court, x, y, 0.025f);
+        }
+    }
+    return court_build(&court);
+}
+
+static void court_sweep_random(uint64_t iterations) {
+    uint32_t rng = 12345;
+    int hits = 0;
+    CourtHit hit;
+    for (uint64_t i = 0; i < iterations; i++) {
+        // Ball-sized moves from anywhere on the court, a few ticks' worth long
+        rng = rng * 1103515245u + 12345u;
+        float x = (rng >> 8 & 1023) / 512.0f - 1.0f;
+        rng = rng * 1103515245u + 12345u;
+        float y = (rng >> 8 & 1023) / 512.0f - 1.0f;
+        float dx = (float)((int)(rng >> 18 & 63) - 32) * 0.001f, dy = (float)((int)(rng >> 24 & 63) - 32) * 0.001f;
+        hits += court_sweep(&court, x, y, dx, dy, 0.03f, &hit);
+    }
+    sink_int = hits;
+}
+
+static GameState court_state;
+
+static int court_tick_setup(void) {
+    if (!court_setup()) return 0;
+    game_init(&court_state, 1);
+    court_state.court = &court;
+    return 1;
+}
+
+static void court_tick(uint64_t iterations) {
+    uint32_t input = 12345;
+    for (uint64_t i = 0; i < iterations; i++) {
+        input = input * 1103515245u + 12345u;
+        game_step(&court_state, (input >> 16) & 15u);
+    }
+    sink_float = court_state.ball.x;
+}
+
+static MultiBall multiball;
+static GameState multiball_court;
+
+static int multiball_setup(void) {
+    multiball_free(&multiball);
+    game_init(&multiball_court, 1);
+    return multiball_init(&multiball, 4096, 0.0f, 1);
+}
+
+static void multiball_tick(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) multiball_step(&multiball, &multiball_court, 0);
+    sink_float = multiball.x[0];
+}
+
+/* Effects: a pool kept near full by a burst before every update, as in a busy rally */
+static ParticlePool particle_pool;
+
+static int particles_setup(void) {
+    particles_init(&particle_pool, 1);
+    for (int i = 0; i < 16; i++) {
+        particles_update(&particle_pool, 0.0f);
+        particles_burst(&particle_pool, 0.0f, 0.0f, 256, 1.0f, 1.0f, 1.0f);
+    }
+    return 1;
+}
+
+static void particles_tick(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        particles_update(&particle_pool, 1.0f / 240.0f);
+        particles_burst(&particle_pool, 0.0f, 0.0f, 64, 1.0f, 1.0f, 1.0f);
+    }
+    sink_int = particle_pool.count;
+}
+
+/* Text */
+
+static void glyph_lookup(uint64_t iterations) {
+    float uv[4];
+    int found = 0;
+    for (uint64_t i = 0; i < iterations; i++) found += font_cell_uv(32 + (uint32_t)(i % 95), uv);
+    sink_int = found;
+    sink_float = uv[0];
+}
+
+static const char* layout_strings[] = { "PLAY", "EXIT", "12", "Left 7 - Right 11", "The quick brown fox jumps over the lazy dog" };
+
+static void text_layout(uint64_t iterations) {
+    float width = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) width += text_width(layout_strings[i % 5], 0.18f);
+    sink_float = width;
+}
+
+/* Utils */
+
+static void clamp_values(uint64_t iterations) {
+    float acc = 0.0f, v = -2.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        acc += clamp(v, -1.0f, 1.0f);
+        v += 0.001f;
+        if (v > 2.0f) v = -2.0f;
+    }
+    sink_float = acc;
+}
+
+/* Assets */
+
+static int font_file_setup(void) {
+    FILE* file = fopen(font_path, "rb");
+    if (!file) return 0;
+    fclose(file);
+    return 1;
+}
+
+static void stbi_load_font(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(font_path, &width, &height, &channels, 4);
+        sink_int = pixels ? pixels[0] : -1;
+        stbi_image_free(pixels);
+    }
+}
+
+static DecodeArena decode_arena;
+
+static int arena_setup(void) {
+    decode_arena_release(&decode_arena);
+    return font_file_setup() && decode_arena_init(&decode_arena, 4 << 20);
+}
+
+// Same decode with every allocation in a reused arena, as load_font_texture does
+static void stbi_load_font_arena(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        decode_arena_begin(&decode_arena);
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(font_path, &width, &height, &channels, 4);
+        sink_int = pixels ? pixels[0] : -1;
+        stbi_image_free(pixels);
+        decode_arena_end(&decode_arena);
+    }
+}
+
+static unsigned char* png_file;
+static int png_size;
+
+// The PNG's bytes in memory, so the decode benchmarks leave the disk out
+static int png_file_setup(void) {
+    if (png_file) return 1;
+    FILE* file = fopen(font_path, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    png_size = (int)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    png_file = malloc(png_size > 0 ? png_size : 1);
+    int ok = png_size > 0 && fread(png_file, 1, png_size, file) == (size_t)png_size;
+    fclose(file);
+    return ok;
+}
+
+static void stbi_decode_png(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load_from_memory(png_file, png_size, &width, &height, &channels, 4);
+        sink_int = pixels ? pixels[0] : -1;
+        stbi_image_free(pixels);
+    }
+}
+
+static void png_decode_one(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        int width, height;
+        unsigned char* pixels = png_decode(png_file, png_size, &width, &height);
+        sink_int = pixels ? pixels[0] : -1;
+        decode_free(pixels);
+    }
+}
+
+#define BATCH_IMAGES 8
+
+// One op is BATCH_IMAGES decodes of the same file spread over every core
+static void png_decode_batch_8(uint64_t iterations) {
+    PngJob jobs[BATCH_IMAGES];
+    for (uint64_t i = 0; i < iterations; i++) {
+        for (int j = 0; j < BATCH_IMAGES; j++) jobs[j] = (PngJob){ .file = png_file, .size = png_size };
+        png_decode_batch(jobs, BATCH_IMAGES, 0);
+        for (int j = 0; j < BATCH_IMAGES; j++) {
+            sink_int = jobs[j].pixels ? jobs[j].pixels[0] : -1;
+            decode_free(jobs[j].pixels);
+        }
+    }
+}
+
+static const Bench benches[] = {
+    { "physics_tick", "game_step with changing paddle input", physics_setup, physics_tick },
+    { "physics_tick_4p", "game_step with four paddles and changing input", four_player_setup, four_player_tick },
+    { "physics_tick_fixed", "game_step on the fixed-point core", fixed_setup, fixed_tick },
+    { "physics_batch_float", "game_step of 1024 matches, float core", batch_float_setup, batch_tick },
+    { "physics_batch_fixed", "game_step of 1024 matches, fixed-point core", batch_fixed_setup, batch_tick },
+    { "paddle_collision", "game_bounce_paddle on a ball touching the paddle", NULL, paddle_collision },
+    { "court_sweep", "court_sweep of a short random move through 196 obstacles", court_setup, court_sweep_random },
+    { "court_tick", "game_step on that court, obstacle bounces included", court_tick_setup, court_tick },
+    { "multiball_tick_4096", "multiball_step with 4096 balls, grid broadphase included", multiball_setup, multiball_tick },
+    { "particles_update", "particles_update of a near-full pool plus a 64-particle burst", particles_setup, particles_tick },
+    { "glyph_lookup", "font.png cell and UVs of a character, as draw_char does", NULL, glyph_lookup },
+    { "text_layout", "text_width over short ASCII strings", NULL, text_layout },
+    { "clamp", "clamp in src/utils.c", NULL, clamp_values },
+    { "stbi_load_font", "stbi_load of font.png to RGBA", font_file_setup, stbi_load_font },
+    { "stbi_load_font_arena", "stbi_load of font.png inside a decode arena scope", arena_setup, stbi_load_font_arena },
+    { "stbi_decode_png", "stbi_load_from_memory of the PNG to RGBA", png_file_setup, stbi_decode_png },
+    { "png_decode", "png_decode of the same bytes", png_file_setup, png_decode_one },
+    { "png_decode_batch_8", "png_decode_batch of 8 copies, one thread per core", png_file_setup, png_decode_batch_8 },
+};
+
+// Smallest batch that takes SAMPLE_NS (Benchmark)
+static uint64_t calibrate(const Bench* bench) {
+    uint64_t iterations = 1;
+    for (;;) {
+        uint64_t start = time_now_ns();
+        bench->run(iterations);
+        uint64_t elapsed = time_now_ns() - start;
+        if (elapsed >= SAMPLE_NS || iterations >= (1ull << 40)) return iterations;
+        // Jump most of the way once the timer can see it, then double
+        iterations = elapsed > SAMPLE_NS / 100 ? iterations * SAMPLE_NS / elapsed + 1 : iterations * 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    int samples = 30;
+    const char* filter = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+            font_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--samples n] [--filter name] [--font font.png]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (samples < 2) samples = 2;
+
+    uint64_t* times = malloc(samples * sizeof(uint64_t));
+    int first = 1;
+    printf("{\n  \"samples\": %d,\n  \"benchmarks\": [", samples);
+
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        const Bench* bench = &benches[b];
+        if (filter && !strstr(bench->name, filter)) continue;
+        if (bench->setup && !bench->setup()) {
+            fprintf(stderr, "%-18s skipped\n", bench->name);
+            continue;
+        }
+
+        uint64_t iterations = calibrate(bench);
+        uint64_t warm_start = time_now_ns();
+        while (time_now_ns() - warm_start < WARMUP_NS) bench->run(iterations);
+
+        double sum = 0.0, sum_sq = 0.0;
+        for (int i = 0; i < samples; i++) {
+            uint64_t start = time_now_ns();
+            bench->run(iterations);
+            times[i] = time_now_ns() - start;
+            double per_op = (double)times[i] / iterations;
+            sum += per_op;
+            sum_sq += per_op * per_op;
+        }
+        qsort(times, samples, sizeof(uint64_t), compare_u64);
+
+        double mean = sum / samples;
+        double variance = (sum_sq - sum * mean) / (samples - 1);
+        double stddev = variance > 0.0 ? sqrt(variance) : 0.0;
+        double median = (double)percentile(times, samples, 50.0) / iterations;
+        fprintf(stderr, "%-18s %12.2f ns/op median (+/- %.2f)\n", bench->name, median, stddev);
+
+        printf("%s\n    {\"name\": \"%s\", \"about\": \"%s\", \"iterations\": %llu, \"ns_per_op\": "
+            "{\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"p95\": %.3f, \"max\": %.3f}}",
+            first ? "" : ",", bench->name, bench->about, (unsigned long long)iterations,
+            (double)times[0] / iterations, median, mean, stddev,
+            (double)percentile(times, samples, 95.0) / iterations, (double)times[samples - 1] / iterations);
+        first = 0;
+    }
+
+    printf("\n  ]\n}\n");
+    free(times);
+    return 0;
+}
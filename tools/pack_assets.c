@@ -0,0 +1,181 @@
+// Build an asset pack for the game
+// cc -O2 -Iinclude tools/pack_assets.c src/decode_arena.c src/png_decode.c src/sdf.c -lm -lpthread -o pack_assets
+// ./pack_assets assets.pak font.png font.ttf
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "asset_pack.h"
+#include "decode_arena.h"
+#include "png_decode.h"
+#include "sdf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES 256
+
+static AssetEntry entries[MAX_ENTRIES];
+static uint32_t entry_count = 0;
+
+// Pad the file with zeros up to the next ASSET_PACK_ALIGN boundary
+static uint64_t align_file(FILE* out, uint64_t pos) {
+    static const unsigned char zeros[ASSET_PACK_ALIGN];
+    uint64_t aligned = (pos + ASSET_PACK_ALIGN - 1) & ~(uint64_t)(ASSET_PACK_ALIGN - 1);
+    fwrite(zeros, 1, aligned - pos, out);
+    return aligned;
+}
+
+// Append one payload and its index entry (Output, Position, Name, Type, Width, Height, Bytes, Size)
+static uint64_t add_entry(FILE* out, uint64_t pos, const char* name, AssetType type,
+                          int width, int height, const void* bytes, uint64_t size) {
+    if (entry_count == MAX_ENTRIES) {
+        fprintf(stderr, "Too many assets\n");
+        exit(1);
+    }
+    if (strlen(name) >= ASSET_NAME_MAX) {
+        fprintf(stderr, "Asset name too long: %s\n", name);
+        exit(1);
+    }
+    pos = align_file(out, pos);
+
+    AssetEntry* entry = &entries[entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    strcpy(entry->name, name);
+    entry->type = type;
+    entry->width = width;
+    entry->height = height;
+    entry->offset = pos;
+    entry->size = size;
+
+    fwrite(bytes, 1, size, out);
+    printf("%-24s %-5s %5d x %-5d %8llu bytes\n", name,
+           type == ASSET_RGBA8 ? "rgba8" : type == ASSET_LA8 ? "la8" : type == ASSET_L8 ? "l8" : "raw",
+           width, height, (unsigned long long)size);
+    return pos + size;
+}
+
+// Read a whole file; NULL on failure
+static unsigned char* read_file(const char* path, uint64_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = malloc(length > 0 ? length : 1);
+    if (length < 0 || fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *size = length;
+    return data;
+}
+
+// File name part of a path
+static const char* base_name(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static int is_png(const char* path) {
+    const char* ext = strrchr(base_name(path), '.');
+    return ext && strcmp(ext, ".png") == 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s out.pak files...\n", argv[0]);
+        return 1;
+    }
+    FILE* out = fopen(argv[1], "wb");
+    if (!out) {
+        fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+
+    /* Every image is decoded up front, in parallel; entries are still written in argument order */
+    static PngJob images[MAX_ENTRIES];
+    static unsigned char* image_files[MAX_ENTRIES];
+    int image_count = 0;
+    for (int i = 2; i < argc; i++) {
+        if (!is_png(argv[i])) continue;
+        if (image_count == MAX_ENTRIES) {
+            fprintf(stderr, "Too many assets\n");
+            return 1;
+        }
+        uint64_t size = 0;
+        image_files[image_count] = read_file(argv[i], &size);
+        images[image_count].file = image_files[image_count];
+        images[image_count].size = image_files[image_count] ? (int)size : 0;
+        image_count++;
+    }
+    png_decode_batch(images, image_count, 0);
+    int next_image = 0;
+
+    /* Header placeholder, rewritten once the index position is known */
+    AssetPackHeader header = {0};
+    fwrite(&header, sizeof(header), 1, out);
+    uint64_t pos = sizeof(header);
+
+    for (int i = 2; i < argc; i++) {
+        const char* path = argv[i];
+        const char* name = base_name(path);
+
+        if (is_png(path)) {
+            /* Images are decoded once here so the game never runs the PNG decoder */
+            PngJob* image = &images[next_image];
+            free(image_files[next_image++]);
+            unsigned char* rgba = image->pixels;
+            int width = image->width, height = image->height;
+            if (!rgba) {
+                fprintf(stderr, "Could not load image: %s\n", path);
+                return 1;
+            }
+            pos = add_entry(out, pos, name, ASSET_RGBA8, width, height, rgba, (uint64_t)width * height * 4);
+
+            /* The font sheet also ships as its finished distance field */
+            if (strcmp(name, "font.png") == 0) {
+                unsigned char* sdf = build_sdf_atlas(rgba, width, height);
+                if (!sdf) {
+                    fprintf(stderr, "Out of memory building the font distance field\n");
+                    return 1;
+                }
+                int sdf_w = width * SDF_SCALE, sdf_h = height * SDF_SCALE;
+                pos = add_entry(out, pos, "font.sdf", ASSET_L8, sdf_w, sdf_h, sdf, (uint64_t)sdf_w * sdf_h);
+                free(sdf);
+            }
+            decode_free(rgba);
+        } else {
+            uint64_t size;
+            unsigned char* data = read_file(path, &size);
+            if (!data) {
+                fprintf(stderr, "Could not read %s\n", path);
+                return 1;
+            }
+            pos = add_entry(out, pos, name, ASSET_RAW, 0, 0, data, size);
+            free(data);
+        }
+    }
+
+    /* Index, then the real header */
+    pos = align_file(out, pos);
+    fwrite(entries, sizeof(AssetEntry), entry_count, out);
+
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.entry_count = entry_count;
+    header.index_offset = pos;
+    header.file_size = pos + (uint64_t)entry_count * sizeof(AssetEntry);
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Could not write %s\n", argv[1]);
+        return 1;
+    }
+    printf("%u assets, %llu bytes -> %s\n", entry_count, (unsigned long long)header.file_size, argv[1]);
+    return 0;
+}
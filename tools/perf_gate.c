@@ -0,0 +1,332 @@
+// Performance regression gate: replays a corpus of matches headless and compares phase timings to a baseline
+// cc -O2 -Iinclude tools/perf_gate.c src/court.c src/game.c src/replay.c src/scene.c src/sdf.c src/soft_raster.c src/utils.c src/y4m.c -lm -o perf_gate
+// ./perf_gate --write-baseline perf.base replays/*.rep      (on the known-good commit)
+// ./perf_gate --baseline perf.base replays/*.rep            (exit status 1 on a regression)
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "replay.h"
+#include "scene.h"
+#include "soft_raster.h"
+#include "utils.h"
+#include "y4m.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Every run re-simulates each replay and renders every tick the way render_replay does,
+   timing each phase separately; a run's sample is the phase's mean ns per tick. Against
+   a baseline, a phase fails when its mean is more than --threshold slower AND Welch's
+   t-test says the slowdown is real (one-sided p below --alpha), so noise alone can't
+   fail the gate and a large but noisy change still has to be consistent.
+   Allocation counts are exact, so any increase fails. */
+
+#define MAX_RUNS 200
+
+enum { PHASE_SIMULATE, PHASE_SCENE, PHASE_RASTER, PHASE_CONVERT, PHASE_COUNT };
+static const char* phase_names[PHASE_COUNT] = { "simulate", "scene", "raster", "convert" };
+
+typedef struct {
+    int runs;
+    double ns_per_tick[MAX_RUNS];
+    long long allocations;       // Per run; -1 = not counted on this platform
+} PhaseSamples;
+
+/* Allocation counting. glibc lets the program's own malloc replace the library's and
+   still reach the real one; elsewhere counts are reported as unavailable. */
+static unsigned long long allocations;
+
+#if defined(__GLIBC__)
+#define COUNT_ALLOCATIONS 1
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    allocations++;
+    return __libc_realloc(pointer, size);
+}
+#else
+#define COUNT_ALLOCATIONS 0
+#endif
+
+/* Statistics */
+
+static double mean_of(const double* values, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += values[i];
+    return sum / n;
+}
+
+static double variance_of(const double* values, int n, double mean) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += (values[i] - mean) * (values[i] - mean);
+    return n > 1 ? sum / (n - 1) : 0.0;
+}
+
+// Continued fraction for the incomplete beta function (modified Lentz)
+static double beta_fraction(double a, double b, double x) {
+    const double tiny = 1e-300;
+    double c = 1.0, d = 1.0 - (a + b) * x / (a + 1.0);
+    if (fabs(d) < tiny) d = tiny;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        double m2 = 2.0 * m;
+        double num = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + num * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1.0 + num / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+
+        num = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + num * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1.0 + num / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        double step = d * c;
+        h *= step;
+        if (fabs(step - 1.0) < 1e-12) break;
+    }
+    return h;
+}
+
+// Regularized incomplete beta I_x(a, b)
+static double incomplete_beta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0)) return front * beta_fraction(a, b, x) / a;
+    return 1.0 - front * beta_fraction(b, a, 1.0 - x) / b;
+}
+
+// One-sided Welch's t-test: probability of a slowdown this large if current were no slower than baseline
+static double welch_p_slower(const PhaseSamples* base, const PhaseSamples* current) {
+    double m1 = mean_of(base->ns_per_tick, base->runs), m2 = mean_of(current->ns_per_tick, current->runs);
+    double v1 = variance_of(base->ns_per_tick, base->runs, m1) / base->runs;
+    double v2 = variance_of(current->ns_per_tick, current->runs, m2) / current->runs;
+    if (v1 + v2 <= 0.0) return m2 > m1 ? 0.0 : 1.0;
+
+    double t = (m2 - m1) / sqrt(v1 + v2);
+    double df = (v1 + v2) * (v1 + v2) / (v1 * v1 / (base->runs - 1) + v2 * v2 / (current->runs - 1));
+    double tail = 0.5 * incomplete_beta(df / 2.0, 0.5, df / (df + t * t));
+    return t > 0.0 ? tail : 1.0 - tail;
+}
+
+/* Baseline file: one line per phase, "name allocations runs sample...", ns per tick */
+
+static int write_baseline(const char* path, const PhaseSamples* phases) {
+    FILE* file = fopen(path, "w");
+    if (!file) return 0;
+    fprintf(file, "# perf_gate baseline v1: phase allocations runs ns_per_tick...\n");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        fprintf(file, "%s %lld %d", phase_names[p], phases[p].allocations, phases[p].runs);
+        for (int i = 0; i < phases[p].runs; i++) fprintf(file, " %.3f", phases[p].ns_per_tick[i]);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+static int read_baseline(const char* path, PhaseSamples* phases) {
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+    char line[256];
+    if (!fgets(line, sizeof(line), file) || strncmp(line, "# perf_gate baseline v1", 23) != 0) {
+        fclose(file);
+        return 0;
+    }
+    int ok = 1;
+    for (int p = 0; p < PHASE_COUNT && ok; p++) {
+        char name[32];
+        ok = fscanf(file, "%31s %lld %d", name, &phases[p].allocations, &phases[p].runs) == 3 &&
+            strcmp(name, phase_names[p]) == 0 && phases[p].runs >= 2 && phases[p].runs <= MAX_RUNS;
+        for (int i = 0; ok && i < phases[p].runs; i++) ok = fscanf(file, "%lf", &phases[p].ns_per_tick[i]) == 1;
+    }
+    fclose(file);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* baseline_path = NULL;
+    int write = 0;
+    int runs = 10;
+    double threshold = 5.0;     // Percent
+    double alpha = 0.01;
+    const char* font_path = "font.png";
+    int width = 500, height = 500;
+    const char* corpus[64];
+    int corpus_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+            write = 1;
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+            font_path = argv[++i];
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                fprintf(stderr, "Bad --size %s, expected WxH\n", argv[i]);
+                return 2;
+            }
+        } else if (argv[i][0] != '-' && corpus_count < 64) {
+            corpus[corpus_count++] = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [--baseline file | --write-baseline file] [--runs n] [--threshold %%] [--alpha p] [--font font.png] [--size WxH] match.rep...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (corpus_count == 0) {
+        fprintf(stderr, "No replays given\n");
+        return 2;
+    }
+    if (runs < 2) runs = 2;
+    if (runs > MAX_RUNS) runs = MAX_RUNS;
+
+    /* Everything the runs need is allocated up front, so the counts only see the phases */
+    Replay replays[64];
+    uint64_t longest = 0, total_ticks = 0;
+    for (int i = 0; i < corpus_count; i++) {
+        if (!replay_load(&replays[i], corpus[i])) {
+            fprintf(stderr, "Could not load replay: %s\n", corpus[i]);
+            return 2;
+        }
+        if (replays[i].end_tick + 1 > longest) longest = replays[i].end_tick + 1;
+        total_ticks += replays[i].end_tick + 1;
+    }
+    int font_w, font_h, channels;
+    unsigned char* font = stbi_load(font_path, &font_w, &font_h, &channels, 4);
+    if (!font) {
+        fprintf(stderr, "Could not load font: %s\n", font_path);
+        return 2;
+    }
+    SoftFont soft_font = { font, font_w, font_h };
+    // replay_load caps end_tick, but a Scene is bigger than a GameState, so size both arrays with a check
+    if (longest > SIZE_MAX / sizeof(GameState) || longest > SIZE_MAX / sizeof(Scene)) {
+        fprintf(stderr, "Replays too long to hold: %llu ticks\n", (unsigned long long)longest);
+        return 2;
+    }
+    GameState* states = malloc(longest * sizeof(GameState));
+    Scene* scenes = malloc(longest * sizeof(Scene));
+    SoftCanvas canvas = { width, height, malloc((size_t)width * height * 4) };
+    unsigned char* planes = malloc(y4m_frame_size(width, height));
+    if (!states || !scenes || !canvas.rgba || !planes) {
+        fprintf(stderr, "Out of memory for %llu ticks at %dx%d\n", (unsigned long long)longest, width, height);
+        return 2;
+    }
+
+    PhaseSamples current[PHASE_COUNT];
+    for (int p = 0; p < PHASE_COUNT; p++) current[p].runs = runs;
+
+    for (int run = 0; run < runs; run++) {
+        uint64_t phase_ns[PHASE_COUNT] = { 0 };
+        unsigned long long phase_allocations[PHASE_COUNT] = { 0 };
+
+        for (int r = 0; r < corpus_count; r++) {
+            uint64_t frames = replays[r].end_tick + 1;
+
+            unsigned long long before = allocations;
+            uint64_t start = time_now_ns();
+            replay_simulate(&replays[r], NULL, states);
+            phase_ns[PHASE_SIMULATE] += time_now_ns() - start;
+            phase_allocations[PHASE_SIMULATE] += allocations - before;
+
+            before = allocations;
+            start = time_now_ns();
+            for (uint64_t f = 0; f < frames; f++) scene_game(&scenes[f], &states[f]);
+            phase_ns[PHASE_SCENE] += time_now_ns() - start;
+            phase_allocations[PHASE_SCENE] += allocations - before;
+
+            // Raster and convert alternate per frame, like render_replay's workers
+            for (uint64_t f = 0; f < frames; f++) {
+                before = allocations;
+                start = time_now_ns();
+                soft_draw_scene(&canvas, &soft_font, &scenes[f]);
+                uint64_t rastered = time_now_ns();
+                phase_allocations[PHASE_RASTER] += allocations - before;
+
+                before = allocations;
+                y4m_convert(canvas.rgba, width, height, 0, planes);
+                phase_ns[PHASE_CONVERT] += time_now_ns() - rastered;
+                phase_ns[PHASE_RASTER] += rastered - start;
+                phase_allocations[PHASE_CONVERT] += allocations - before;
+            }
+        }
+
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            current[p].ns_per_tick[run] = (double)phase_ns[p] / total_ticks;
+            current[p].allocations = COUNT_ALLOCATIONS ? (long long)phase_allocations[p] : -1;
+        }
+        fprintf(stderr, "\rrun %d/%d", run + 1, runs);
+    }
+    fprintf(stderr, "\n");
+
+    PhaseSamples base[PHASE_COUNT];
+    int have_base = !write && baseline_path;
+    if (have_base && !read_baseline(baseline_path, base)) {
+        fprintf(stderr, "Could not read baseline: %s\n", baseline_path);
+        return 2;
+    }
+
+    printf("perf_gate: %d replays, %llu ticks, %dx%d, %d runs\n", corpus_count, (unsigned long long)total_ticks, width, height, runs);
+    printf("  %-9s %12s %10s %8s", "phase", "ns/tick", "+/-", "allocs");
+    if (have_base) printf(" %12s %9s %9s  %s", "baseline", "change", "p", "verdict");
+    printf("\n");
+
+    int failed = 0;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double mean = mean_of(current[p].ns_per_tick, runs);
+        double spread = sqrt(variance_of(current[p].ns_per_tick, runs, mean));
+        printf("  %-9s %12.1f %10.1f %8lld", phase_names[p], mean, spread, current[p].allocations);
+        if (have_base) {
+            double base_mean = mean_of(base[p].ns_per_tick, base[p].runs);
+            double change = (mean / base_mean - 1.0) * 100.0;
+            double p_value = welch_p_slower(&base[p], &current[p]);
+            int slower = change > threshold && p_value < alpha;
+            int more_allocations = current[p].allocations >= 0 && base[p].allocations >= 0 &&
+                current[p].allocations > base[p].allocations;
+            const char* verdict = slower && more_allocations ? "FAIL (time, allocations)" :
+                slower ? "FAIL (time)" : more_allocations ? "FAIL (allocations)" : "ok";
+            printf(" %12.1f %+8.1f%% %9.4f  %s", base_mean, change, p_value, verdict);
+            failed |= slower || more_allocations;
+        }
+        printf("\n");
+    }
+
+    if (write && !write_baseline(baseline_path, current)) {
+        fprintf(stderr, "Could not write baseline: %s\n", baseline_path);
+        failed = 1;
+    }
+    if (have_base) printf("perf_gate: %s (threshold %.1f%%, alpha %g)\n", failed ? "REGRESSION" : "pass", threshold, alpha);
+
+    free(planes);
+    free(canvas.rgba);
+    free(scenes);
+    free(states);
+    stbi_image_free(font);
+    for (int i = 0; i < corpus_count; i++) replay_free(&replays[i]);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+// Check png_decode against stb_image, pixel for pixel
+// cc -O2 -Iinclude tools/png_check.c src/decode_arena.c src/png_decode.c -lm -lpthread -o png_check
+// ./png_check images/*.png
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "png_decode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Whole file into memory; NULL on failure (Path, Output size)
+static unsigned char* read_file(const char* path, int* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = length >= 0 && length <= 0x7FFFFFFF ? malloc(length > 0 ? length : 1) : NULL;
+    if (!data || fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *size = (int)length;
+    return data;
+}
+
+// First differing pixel of two RGBA8 images, -1 if none (Pixels, Pixels, Pixel count)
+static long first_difference(const unsigned char* a, const unsigned char* b, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        if (memcmp(a + i * 4, b + i * 4, 4) != 0) return (long)i;
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s file.png...\n", argv[0]);
+        return 2;
+    }
+
+    /* Both decoders on every file: the images must match exactly, or both must be rejected */
+    int matched = 0, rejected = 0, mismatched = 0, unreadable = 0;
+    for (int i = 1; i < argc; i++) {
+        int size;
+        unsigned char* file = read_file(argv[i], &size);
+        if (!file) {
+            fprintf(stderr, "Could not read %s\n", argv[i]);
+            unreadable++;
+            continue;
+        }
+
+        int stb_w = 0, stb_h = 0, channels, fast_w = 0, fast_h = 0;
+        unsigned char* expected = stbi_load_from_memory(file, size, &stb_w, &stb_h, &channels, 4);
+        unsigned char* actual = png_decode(file, size, &fast_w, &fast_h);
+        free(file);
+
+        if (!expected && !actual) {
+            rejected++;
+        } else if (!expected || !actual) {
+            printf("%s: %s\n", argv[i], expected ? "png_decode failed, stb_image decoded it" : "png_decode decoded it, stb_image failed");
+            mismatched++;
+        } else if (stb_w != fast_w || stb_h != fast_h) {
+            printf("%s: %dx%d, stb_image %dx%d\n", argv[i], fast_w, fast_h, stb_w, stb_h);
+            mismatched++;
+        } else {
+            long pixel = first_difference(expected, actual, (size_t)stb_w * stb_h);
+            if (pixel < 0) {
+                matched++;
+            } else {
+                const unsigned char* e = expected + pixel * 4;
+                const unsigned char* a = actual + pixel * 4;
+                printf("%s: pixel (%ld, %ld) is %02x%02x%02x%02x, stb_image %02x%02x%02x%02x\n", argv[i],
+                    pixel % stb_w, pixel / stb_w, a[0], a[1], a[2], a[3], e[0], e[1], e[2], e[3]);
+                mismatched++;
+            }
+        }
+        stbi_image_free(expected);
+        stbi_image_free(actual);
+    }
+
+    printf("%d identical, %d rejected by both, %d different, %d unreadable\n", matched, rejected, mismatched, unreadable);
+    return mismatched || unreadable ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+// Render a recorded match (--record) to video without a window or GPU
+// cc -O2 -Iinclude tools/render_replay.c src/court.c src/game.c src/replay.c src/scene.c src/sdf.c src/soft_raster.c src/y4m.c -lm -lpthread -o render_replay
+// ./render_replay match.rep match.y4m [--size WxH] [--threads n] [--font font.png] [--court file.court]
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "replay.h"
+#include "scene.h"
+#include "soft_raster.h"
+#include "y4m.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 256
+
+/* Frames are independent once every state is known, so the match is simulated first
+   (cheap, serial) and the frames are rasterized and converted by a pool of workers.
+   Frame f lives in slot f % slot_count; a worker may only start it once the writer has
+   written frame f - slot_count, which keeps memory bounded and the output in order. */
+
+static struct {
+    const GameState* states;
+    uint64_t frame_count;
+    int width, height;
+    SoftFont font;
+
+    int slot_count;
+    unsigned char** planes;      // Converted frame per slot
+    uint64_t* slot_frame;        // Frame a slot may hold next
+    int* slot_done;              // Slot holds a finished frame
+    uint64_t next_frame;         // Next frame to hand to a worker
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} job;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Worker: renders frames into its own canvas, allocated by main so a failure is reported there (Canvas)
+static void* render_worker(void* arg) {
+    SoftCanvas canvas = *(SoftCanvas*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&job.lock);
+        if (job.next_frame == job.frame_count) {
+            pthread_mutex_unlock(&job.lock);
+            break;
+        }
+        uint64_t frame = job.next_frame++;
+        int slot = (int)(frame % job.slot_count);
+        while (job.slot_frame[slot] != frame) pthread_cond_wait(&job.changed, &job.lock);
+        pthread_mutex_unlock(&job.lock);
+
+        Scene scene;
+        scene_game(&scene, &job.states[frame]);
+        soft_draw_scene(&canvas, &job.font, &scene);
+        y4m_convert(canvas.rgba, job.width, job.height, 0, job.planes[slot]);
+
+        pthread_mutex_lock(&job.lock);
+        job.slot_done[slot] = 1;
+        pthread_cond_broadcast(&job.changed);
+        pthread_mutex_unlock(&job.lock);
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s match.rep out.y4m [--size WxH] [--threads n] [--font font.png] [--court file.court]\n", argv[0]);
+        return 1;
+    }
+    const char* replay_path = argv[1];
+    const char* out_path = argv[2];
+    const char* font_path = "font.png";
+    const char* court_path = NULL;
+    int width = 500, height = 500;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                fprintf(stderr, "Bad --size %s, expected WxH\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+            font_path = argv[++i];
+        } else if (strcmp(argv[i], "--court") == 0 && i + 1 < argc) {
+            court_path = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    Replay replay;
+    if (!replay_load(&replay, replay_path)) {
+        fprintf(stderr, "Could not load replay: %s\n", replay_path);
+        return 1;
+    }
+    Court court;
+    if (court_path && !court_load(&court, court_path)) return 1;
+    int font_w, font_h, channels;
+    unsigned char* font = stbi_load(font_path, &font_w, &font_h, &channels, 4);
+    if (!font) {
+        fprintf(stderr, "Could not load font: %s\n", font_path);
+        return 1;
+    }
+    FILE* out = fopen(out_path, "wb");
+    if (!out) {
+        fprintf(stderr, "Could not open %s\n", out_path);
+        return 1;
+    }
+
+    double start = now_seconds();
+
+    /* Serial part: one state per tick, the starting state included */
+    GameState* states = malloc((replay.end_tick + 1) * sizeof(GameState));
+    if (!states) {
+        fprintf(stderr, "Out of memory for %llu ticks of game state\n", (unsigned long long)replay.end_tick + 1);
+        return 1;
+    }
+    replay_simulate(&replay, court_path ? &court : NULL, states);
+    double simulated = now_seconds();
+
+    job.states = states;
+    job.frame_count = replay.end_tick + 1;
+    job.width = width;
+    job.height = height;
+    job.font = (SoftFont){ font, font_w, font_h };
+    job.slot_count = threads * 2;
+    job.planes = calloc(job.slot_count, sizeof(unsigned char*));
+    job.slot_frame = malloc(job.slot_count * sizeof(uint64_t));
+    job.slot_done = calloc(job.slot_count, sizeof(int));
+    pthread_t* workers = malloc(threads * sizeof(pthread_t));
+    SoftCanvas* canvases = calloc(threads, sizeof(SoftCanvas));
+    int allocated = job.planes && job.slot_frame && job.slot_done && workers && canvases;
+    size_t frame_size = y4m_frame_size(width, height);
+    for (int i = 0; allocated && i < job.slot_count; i++) {
+        job.planes[i] = malloc(frame_size);
+        job.slot_frame[i] = i;
+        if (!job.planes[i]) allocated = 0;
+    }
+    for (int i = 0; allocated && i < threads; i++) {
+        canvases[i] = (SoftCanvas){ width, height, malloc((size_t)width * height * 4) };
+        if (!canvases[i].rgba) allocated = 0;
+    }
+    if (!allocated) {
+        fprintf(stderr, "Out of memory for %d threads at %dx%d\n", threads, width, height);
+        return 1;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.changed, NULL);
+
+    // Workers pull frames until none are left, so fewer than asked still finish the video
+    int started = 0;
+    while (started < threads && pthread_create(&workers[started], NULL, render_worker, &canvases[started]) == 0) started++;
+    if (started == 0) {
+        fprintf(stderr, "Could not start a render thread\n");
+        return 1;
+    }
+    if (started < threads) fprintf(stderr, "Only %d of %d render threads started\n", started, threads);
+
+    /* Writer: frames leave in order as soon as each is done */
+    y4m_write_header(out, width, height, replay.tick_rate);
+    for (uint64_t frame = 0; frame < job.frame_count; frame++) {
+        int slot = (int)(frame % job.slot_count);
+        pthread_mutex_lock(&job.lock);
+        while (!job.slot_done[slot]) pthread_cond_wait(&job.changed, &job.lock);
+        pthread_mutex_unlock(&job.lock);
+
+        y4m_write_frame(out, job.planes[slot], width, height);
+
+        pthread_mutex_lock(&job.lock);
+        job.slot_done[slot] = 0;
+        job.slot_frame[slot] = frame + job.slot_count;
+        pthread_cond_broadcast(&job.changed);
+        pthread_mutex_unlock(&job.lock);
+    }
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+
+    int ok = fclose(out) == 0;
+    double done = now_seconds();
+    fprintf(stderr, "%llu frames (%.1f s of play) at %dx%d on %d threads: simulate %.3f s, render %.3f s (%.0f fps)\n",
+        (unsigned long long)job.frame_count, job.frame_count / replay.tick_rate, width, height, started,
+        simulated - start, done - simulated, job.frame_count / (done - simulated));
+
+    for (int i = 0; i < job.slot_count; i++) free(job.planes[i]);
+    free(job.planes);
+    free(job.slot_frame);
+    free(job.slot_done);
+    for (int i = 0; i < threads; i++) free(canvases[i].rgba);
+    free(canvases);
+    free(workers);
+    free(states);
+    stbi_image_free(font);
+    replay_free(&replay);
+    if (court_path) court_free(&court);
+    return ok ? 0 : 1;
+}